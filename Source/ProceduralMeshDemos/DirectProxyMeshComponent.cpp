@@ -11,49 +11,555 @@
 #include "DynamicMeshBuilder.h"
 #include "MaterialDomain.h"
 #include "StaticMeshResources.h"
+#include "LocalVertexFactory.h"
 #include "SceneManagement.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "UObject/UObjectIterator.h"
+#include "DirectProxyHeightFieldShaders.h"
+#include <atomic>
 
-// Data sent to the render thread for dynamic updates
-struct FDirectProxyDynamicData
+DEFINE_LOG_CATEGORY_STATIC(LogDirectProxyMesh, Log, All);
+LLM_DEFINE_TAG(DirectProxyMesh);
+
+static TAutoConsoleVariable<int32> CVarDirectProxyNumBufferedFrames(
+	TEXT("r.DirectProxyMesh.NumBufferedFrames"),
+	3,
+	TEXT("Number of rotating position/tangent buffers per direct proxy mesh (1-4).\n")
+	TEXT("More than one lets uploads write a buffer the GPU is not reading for a frame in flight.\n")
+	TEXT("Takes effect when the scene proxy is recreated."),
+	ECVF_RenderThreadSafe);
+
+// Upper bound for r.DirectProxyMesh.NumBufferedFrames
+static constexpr int32 MaxBufferedFrames = 4;
+
+static int32 GetNumBufferedFrames()
+{
+	return FMath::Clamp(CVarDirectProxyNumBufferedFrames.GetValueOnAnyThread(), 1, MaxBufferedFrames);
+}
+
+static TAutoConsoleVariable<int32> CVarDirectProxyStaticDrawIdleFrames(
+	TEXT("r.DirectProxyMesh.StaticDrawIdleFrames"),
+	8,
+	TEXT("Frames without updates before a direct proxy mesh switches to cached static draw commands.\n")
+	TEXT("The mesh goes back to per-frame dynamic mesh collection as soon as a new frame is submitted.\n")
+	TEXT("0 keeps every direct proxy mesh on the dynamic path."),
+	ECVF_Default);
+
+DECLARE_STATS_GROUP(TEXT("DirectProxyMesh"), STATGROUP_DirectProxyMesh, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Uploads"), STAT_DirectProxyMesh_Uploads, STATGROUP_DirectProxyMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bytes Uploaded"), STAT_DirectProxyMesh_BytesUploaded, STATGROUP_DirectProxyMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Partial Uploads"), STAT_DirectProxyMesh_PartialUploads, STATGROUP_DirectProxyMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Static Draw Path Switches"), STAT_DirectProxyMesh_StaticSwitches, STATGROUP_DirectProxyMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Updates Coalesced"), STAT_DirectProxyMesh_UpdatesCoalesced, STATGROUP_DirectProxyMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Updates Dropped"), STAT_DirectProxyMesh_UpdatesDropped, STATGROUP_DirectProxyMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Auto Bounds Updates"), STAT_DirectProxyMesh_AutoBoundsUpdates, STATGROUP_DirectProxyMesh);
+DECLARE_CYCLE_STAT(TEXT("Pack Tangents (Workers)"), STAT_DirectProxyMesh_PackTangents, STATGROUP_DirectProxyMesh);
+DECLARE_CYCLE_STAT(TEXT("Upload (Render Thread)"), STAT_DirectProxyMesh_Upload, STATGROUP_DirectProxyMesh);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Unique Topologies"), STAT_DirectProxyMesh_NumTopologies, STATGROUP_DirectProxyMesh);
+DECLARE_MEMORY_STAT(TEXT("Topology Memory (Unique)"), STAT_DirectProxyMesh_TopologyUniqueMemory, STATGROUP_DirectProxyMesh);
+DECLARE_MEMORY_STAT(TEXT("Topology Memory (Saved By Sharing)"), STAT_DirectProxyMesh_TopologySharedMemory, STATGROUP_DirectProxyMesh);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Render Thread Time Saved (ms)"), STAT_DirectProxyMesh_RenderThreadTimeSaved, STATGROUP_DirectProxyMesh);
+DECLARE_MEMORY_STAT(TEXT("Vertex Stream Memory (GPU)"), STAT_DirectProxyMesh_VertexStreamMemory, STATGROUP_DirectProxyMesh);
+DECLARE_MEMORY_STAT(TEXT("Topology Buffer Memory (GPU)"), STAT_DirectProxyMesh_TopologyGPUMemory, STATGROUP_DirectProxyMesh);
+DECLARE_MEMORY_STAT(TEXT("Idle Pooled Frame Memory"), STAT_DirectProxyMesh_FramePoolMemory, STATGROUP_DirectProxyMesh);
+
+// Ranges closer than this are uploaded with one lock; re-sending a few clean vertices is cheaper than another lock
+static constexpr int32 DirtyRangeMergeGap = 64;
+
+void FDirectProxyDirtyRange::AddGridRect(TArray<FDirectProxyDirtyRange>& OutRanges, int32 RowLength, const FIntRect& Rect)
+{
+	const int32 MinColumn = FMath::Max(Rect.Min.X, 0);
+	const int32 MaxColumn = FMath::Min(Rect.Max.X, RowLength);
+	const int32 MinRow = FMath::Max(Rect.Min.Y, 0);
+	if (MaxColumn <= MinColumn || Rect.Max.Y <= MinRow)
+	{
+		return;
+	}
+
+	// A rect spanning whole rows is one contiguous range
+	if (MinColumn == 0 && MaxColumn == RowLength)
+	{
+		OutRanges.Emplace(MinRow * RowLength, (Rect.Max.Y - MinRow) * RowLength);
+		return;
+	}
+
+	for (int32 Row = MinRow; Row < Rect.Max.Y; Row++)
+	{
+		OutRanges.Emplace(Row * RowLength + MinColumn, MaxColumn - MinColumn);
+	}
+}
+
+// Clamps ranges to the vertex count, sorts them and merges overlapping or nearly adjacent ones
+static void MergeDirtyRanges(TArray<FDirectProxyDirtyRange>& Ranges, int32 NumVertices)
+{
+	for (int32 i = Ranges.Num() - 1; i >= 0; i--)
+	{
+		FDirectProxyDirtyRange& Range = Ranges[i];
+		const int32 First = FMath::Clamp(Range.FirstVertex, 0, NumVertices);
+		const int32 Last = FMath::Clamp(Range.FirstVertex + Range.NumVertices, 0, NumVertices);
+		if (Last <= First)
+		{
+			Ranges.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+		Range = FDirectProxyDirtyRange(First, Last - First);
+	}
+
+	Ranges.Sort([](const FDirectProxyDirtyRange& A, const FDirectProxyDirtyRange& B) { return A.FirstVertex < B.FirstVertex; });
+
+	int32 NumMerged = 0;
+	for (int32 i = 0; i < Ranges.Num(); i++)
+	{
+		if (NumMerged > 0)
+		{
+			FDirectProxyDirtyRange& Prev = Ranges[NumMerged - 1];
+			const int32 PrevEnd = Prev.FirstVertex + Prev.NumVertices;
+			if (Ranges[i].FirstVertex <= PrevEnd + DirtyRangeMergeGap)
+			{
+				Prev.NumVertices = FMath::Max(PrevEnd, Ranges[i].FirstVertex + Ranges[i].NumVertices) - Prev.FirstVertex;
+				continue;
+			}
+		}
+		Ranges[NumMerged++] = Ranges[i];
+	}
+	Ranges.SetNum(NumMerged, EAllowShrinking::No);
+}
+
+// ============================================================================
+// Frame Pool
+// ============================================================================
+
+// Hands out ref-counted frames and takes them back when their last reference is released.
+// The render command that uploads a frame holds the final reference, so a frame only returns
+// to the pool after its data has been copied into the RHI buffer.
+class FDirectProxyFramePool : public TSharedFromThis<FDirectProxyFramePool, ESPMode::ThreadSafe>
 {
-	TArray<FVector3f> Positions;
-	TArray<FVector3f> Normals;
+public:
+	// Upper bound on idle frames kept around; anything beyond that is freed
+	static constexpr int32 MaxFreeFrames = 4;
+
+	~FDirectProxyFramePool()
+	{
+		for (FDirectProxyFrame* Frame : FreeFrames)
+		{
+			DEC_MEMORY_STAT_BY(STAT_DirectProxyMesh_FramePoolMemory, Frame->GetAllocatedSize());
+			delete Frame;
+		}
+	}
+
+	FDirectProxyFrameRef Acquire(int32 NumVertices, EDirectProxyFrameLayout Layout)
+	{
+		LLM_SCOPE_BYTAG(DirectProxyMesh);
+
+		FDirectProxyFrame* Frame = nullptr;
+		{
+			FScopeLock Lock(&CriticalSection);
+			if (FreeFrames.Num() > 0)
+			{
+				Frame = FreeFrames.Pop(EAllowShrinking::No);
+				IdleMemorySize -= Frame->GetAllocatedSize();
+				DEC_MEMORY_STAT_BY(STAT_DirectProxyMesh_FramePoolMemory, Frame->GetAllocatedSize());
+			}
+		}
+		if (!Frame)
+		{
+			Frame = new FDirectProxyFrame();
+		}
+
+		SizeFrame(*Frame, NumVertices, Layout);
+
+		// The last reference can be dropped on the render thread after the pool's owner is gone,
+		// so only a weak reference to the pool is captured.
+		TWeakPtr<FDirectProxyFramePool, ESPMode::ThreadSafe> WeakPool = AsShared();
+		return MakeShareable(Frame, [WeakPool](FDirectProxyFrame* InFrame)
+		{
+			if (TSharedPtr<FDirectProxyFramePool, ESPMode::ThreadSafe> Pool = WeakPool.Pin())
+			{
+				Pool->Recycle(InFrame);
+			}
+			else
+			{
+				delete InFrame;
+			}
+		});
+	}
+
+	// Sizes every stream for the layout; streams the layout doesn't use are left empty.
+	// Recycled frames already have the capacity, so this is allocation free in steady state.
+	static void SizeFrame(FDirectProxyFrame& Frame, int32 NumVertices, EDirectProxyFrameLayout Layout)
+	{
+		const bool bHeights = Layout == EDirectProxyFrameLayout::Heights;
+		Frame.Positions.SetNumUninitialized(bHeights ? 0 : NumVertices, EAllowShrinking::No);
+		Frame.Normals.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+		Frame.TangentBasis.SetNumUninitialized(bHeights ? 0 : NumVertices * 2, EAllowShrinking::No);
+		Frame.QuantizedPositions.SetNumUninitialized(Layout == EDirectProxyFrameLayout::QuantizedPositions ? NumVertices : 0, EAllowShrinking::No);
+		Frame.Heights.SetNumUninitialized(bHeights ? NumVertices : 0, EAllowShrinking::No);
+		Frame.PackedNormals.SetNumUninitialized(bHeights ? NumVertices : 0, EAllowShrinking::No);
+		Frame.Layout = Layout;
+	}
+
+	// CPU memory held by frames waiting in the pool; frames in use are accounted by whoever holds them
+	SIZE_T GetIdleMemorySize()
+	{
+		FScopeLock Lock(&CriticalSection);
+		return IdleMemorySize + FreeFrames.GetAllocatedSize();
+	}
+
+private:
+	void Recycle(FDirectProxyFrame* Frame)
+	{
+		{
+			FScopeLock Lock(&CriticalSection);
+			if (FreeFrames.Num() < MaxFreeFrames)
+			{
+				// Idle frames don't change size, so this is what comes off again when the frame is reused
+				IdleMemorySize += Frame->GetAllocatedSize();
+				INC_MEMORY_STAT_BY(STAT_DirectProxyMesh_FramePoolMemory, Frame->GetAllocatedSize());
+				FreeFrames.Push(Frame);
+				return;
+			}
+		}
+		delete Frame;
+	}
+
+	FCriticalSection CriticalSection;
+	TArray<FDirectProxyFrame*> FreeFrames;
+	SIZE_T IdleMemorySize = 0;
 };
 
+// Copies every stream the two frames carry at the same size
+static void CopyFrameContents(const FDirectProxyFrame& Source, FDirectProxyFrame& Dest)
+{
+	auto CopyStream = [](const auto& From, auto& To)
+	{
+		if (From.Num() == To.Num())
+		{
+			FMemory::Memcpy(To.GetData(), From.GetData(), To.Num() * To.GetTypeSize());
+		}
+	};
+	CopyStream(Source.Positions, Dest.Positions);
+	CopyStream(Source.Normals, Dest.Normals);
+	CopyStream(Source.TangentBasis, Dest.TangentBasis);
+	CopyStream(Source.QuantizedPositions, Dest.QuantizedPositions);
+	CopyStream(Source.Heights, Dest.Heights);
+	CopyStream(Source.PackedNormals, Dest.PackedNormals);
+}
+
 // ============================================================================
 // Custom Buffer Classes
 // ============================================================================
 
+// Packs a tangent basis for each normal: tangent first, then the normal with W = 127 (no binormal flip).
+// The tangent is Cross(Z, N), or Cross(X, N) when N is close to Z, normalized. Both candidates are built
+// in SIMD registers and selected with a mask rather than a branch.
+static void PackTangentBasis(const FVector3f* RESTRICT Normals, FPackedNormal* RESTRICT OutTangentData, int32 NumVerts)
+{
+	const VectorRegister4Float AxisZ = MakeVectorRegisterFloat(0.0f, 0.0f, 1.0f, 0.0f);
+	const VectorRegister4Float AxisX = MakeVectorRegisterFloat(1.0f, 0.0f, 0.0f, 0.0f);
+	const VectorRegister4Float NearZThreshold = VectorSetFloat1(0.999f);
+	const VectorRegister4Float SafeNormalTolerance = VectorSetFloat1(UE_SMALL_NUMBER);
+
+	for (int32 i = 0; i < NumVerts; i++)
+	{
+		const VectorRegister4Float Normal = VectorLoadFloat3(&Normals[i].X);
+		const VectorRegister4Float UseZ = VectorCompareLT(VectorAbs(VectorReplicate(Normal, 2)), NearZThreshold);
+		const VectorRegister4Float RawTangent = VectorSelect(UseZ, VectorCross(AxisZ, Normal), VectorCross(AxisX, Normal));
+
+		// Same as GetSafeNormal: zero when the length is too small to normalize
+		const VectorRegister4Float LengthSquared = VectorDot3(RawTangent, RawTangent);
+		const VectorRegister4Float Tangent = VectorSelect(VectorCompareGT(LengthSquared, SafeNormalTolerance),
+			VectorMultiply(RawTangent, VectorReciprocalSqrt(LengthSquared)), VectorZeroFloat());
+
+		FVector3f TangentOut;
+		VectorStoreFloat3(Tangent, &TangentOut.X);
+		OutTangentData[i * 2 + 0] = FPackedNormal(TangentOut);
+		OutTangentData[i * 2 + 1] = FPackedNormal(Normals[i]);
+		OutTangentData[i * 2 + 1].Vector.W = 127;
+	}
+}
+
+// Packs only the normal (W = 127) for height field frames; the expand shader derives the tangent on the GPU
+static void PackNormals(const FVector3f* RESTRICT Normals, FPackedNormal* RESTRICT OutNormals, int32 NumVerts)
+{
+	for (int32 i = 0; i < NumVerts; i++)
+	{
+		OutNormals[i] = FPackedNormal(Normals[i]);
+		OutNormals[i].Vector.W = 127;
+	}
+}
+
+// Largest value of a 16-bit normalized component
+static constexpr float QuantizedPositionRange = 65535.0f;
+
+// Encoding parameters for quantized positions: [Min, Min + Size] maps to [0, 65535]
+struct FDirectProxyQuantization
+{
+	FVector3f Min;
+	FVector3f Scale;
+	FVector3f InvScale;
+	bool bMeasureError = false;
+
+	explicit FDirectProxyQuantization(const FBox& Bounds, bool bInMeasureError)
+		: Min(FVector3f(Bounds.Min))
+		, bMeasureError(bInMeasureError)
+	{
+		const FVector3f Size = FVector3f(Bounds.GetSize()).ComponentMax(FVector3f(UE_KINDA_SMALL_NUMBER));
+		Scale = FVector3f(QuantizedPositionRange) / Size;
+		InvScale = Size / QuantizedPositionRange;
+	}
+};
+
+// Encodes positions to 16 bits per axis. Returns the largest encoding error when measuring, otherwise 0.
+static float QuantizePositions(const FVector3f* RESTRICT Positions, FDirectProxyQuantizedPosition* RESTRICT OutPositions, int32 NumVerts, const FDirectProxyQuantization& Quantization)
+{
+	float MaxErrorSquared = 0.0f;
+	for (int32 i = 0; i < NumVerts; i++)
+	{
+		const FVector3f Normalized = (Positions[i] - Quantization.Min) * Quantization.Scale;
+		FDirectProxyQuantizedPosition& Out = OutPositions[i];
+		Out.X = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(Normalized.X), 0, 65535));
+		Out.Y = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(Normalized.Y), 0, 65535));
+		Out.Z = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(Normalized.Z), 0, 65535));
+		Out.W = 65535;
+
+		if (Quantization.bMeasureError)
+		{
+			const FVector3f Decoded = Quantization.Min + FVector3f(Out.X, Out.Y, Out.Z) * Quantization.InvScale;
+			MaxErrorSquared = FMath::Max(MaxErrorSquared, FVector3f::DistSquared(Decoded, Positions[i]));
+		}
+	}
+	return FMath::Sqrt(MaxErrorSquared);
+}
+
+// Vertices per worker task when preparing a frame
+static constexpr int32 PrepareFrameBatchSize = 8192;
+
+// Packs the tangent basis (and encodes positions when quantizing) for a vertex range on worker threads.
+// Height field frames only get their normals packed. Returns the largest quantization error measured, or 0.
+static float PrepareFrameParallel(FDirectProxyFrame& Frame, int32 FirstVertex, int32 NumVerts, const FDirectProxyQuantization* Quantization)
+{
+	const int32 NumBatches = FMath::DivideAndRoundUp(NumVerts, PrepareFrameBatchSize);
+	TArray<float, TInlineAllocator<64>> BatchErrors;
+	BatchErrors.SetNumZeroed(NumBatches);
+
+	ParallelFor(NumBatches, [&Frame, &BatchErrors, FirstVertex, NumVerts, Quantization](int32 BatchIndex)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DirectProxyMesh_PackTangents);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		const int32 BatchStart = FirstVertex + BatchIndex * PrepareFrameBatchSize;
+		const int32 BatchCount = FMath::Min(PrepareFrameBatchSize, FirstVertex + NumVerts - BatchStart);
+		if (Frame.Layout == EDirectProxyFrameLayout::Heights)
+		{
+			PackNormals(Frame.Normals.GetData() + BatchStart, Frame.PackedNormals.GetData() + BatchStart, BatchCount);
+		}
+		else
+		{
+			PackTangentBasis(Frame.Normals.GetData() + BatchStart, Frame.TangentBasis.GetData() + BatchStart * 2, BatchCount);
+		}
+
+		// This used to run on the render thread, one vertex at a time
+		INC_FLOAT_STAT_BY(STAT_DirectProxyMesh_RenderThreadTimeSaved, static_cast<float>(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles)));
+
+		if (Quantization)
+		{
+			BatchErrors[BatchIndex] = QuantizePositions(Frame.Positions.GetData() + BatchStart, Frame.QuantizedPositions.GetData() + BatchStart, BatchCount, *Quantization);
+		}
+	}, NumBatches <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	float MaxError = 0.0f;
+	for (const float BatchError : BatchErrors)
+	{
+		MaxError = FMath::Max(MaxError, BatchError);
+	}
+	return MaxError;
+}
+
+// Meshes at least this large reduce their bounds on worker threads, one batch per task
+static constexpr int32 BoundsBatchSize = 32768;
+
+// Min/max of a position range, one vertex per SIMD register
+static void ReducePositionBounds(const FVector3f* RESTRICT Positions, int32 NumVerts, VectorRegister4Float& InOutMin, VectorRegister4Float& InOutMax)
+{
+	VectorRegister4Float Min = InOutMin;
+	VectorRegister4Float Max = InOutMax;
+	for (int32 i = 0; i < NumVerts; i++)
+	{
+		const VectorRegister4Float Position = VectorLoadFloat3(&Positions[i].X);
+		Min = VectorMin(Min, Position);
+		Max = VectorMax(Max, Position);
+	}
+	InOutMin = Min;
+	InOutMax = Max;
+}
+
+// Min/max of a height range, four heights per SIMD register; the result is replicated into every lane
+static void ReduceHeightBounds(const float* RESTRICT Heights, int32 NumVerts, VectorRegister4Float& InOutMin, VectorRegister4Float& InOutMax)
+{
+	VectorRegister4Float Min = InOutMin;
+	VectorRegister4Float Max = InOutMax;
+	int32 i = 0;
+	for (; i + 4 <= NumVerts; i += 4)
+	{
+		const VectorRegister4Float Values = VectorLoad(Heights + i);
+		Min = VectorMin(Min, Values);
+		Max = VectorMax(Max, Values);
+	}
+	for (; i < NumVerts; i++)
+	{
+		const VectorRegister4Float Value = VectorSetFloat1(Heights[i]);
+		Min = VectorMin(Min, Value);
+		Max = VectorMax(Max, Value);
+	}
+
+	// Fold the four lanes together
+	Min = VectorMin(Min, VectorSwizzle(Min, 2, 3, 0, 1));
+	Min = VectorMin(Min, VectorSwizzle(Min, 1, 0, 3, 2));
+	Max = VectorMax(Max, VectorSwizzle(Max, 2, 3, 0, 1));
+	Max = VectorMax(Max, VectorSwizzle(Max, 1, 0, 3, 2));
+	InOutMin = Min;
+	InOutMax = Max;
+}
+
+// Tight local bounds of a vertex range of a frame. Height frames take X/Y from the grid bounds, which don't change.
+static FBox ComputeFrameBounds(const FDirectProxyFrame& Frame, int32 FirstVertex, int32 NumVerts, const FBox2f& GridBounds)
+{
+	// Quantized frames always have fixed bounds
+	if (NumVerts <= 0 || Frame.Layout == EDirectProxyFrameLayout::QuantizedPositions)
+	{
+		return FBox(ForceInit);
+	}
+
+	const bool bHeights = Frame.Layout == EDirectProxyFrameLayout::Heights;
+	const int32 NumBatches = FMath::DivideAndRoundUp(NumVerts, BoundsBatchSize);
+	TArray<VectorRegister4Float, TInlineAllocator<64>> BatchMin;
+	TArray<VectorRegister4Float, TInlineAllocator<64>> BatchMax;
+	BatchMin.Init(VectorSetFloat1(UE_BIG_NUMBER), NumBatches);
+	BatchMax.Init(VectorSetFloat1(-UE_BIG_NUMBER), NumBatches);
+
+	ParallelFor(NumBatches, [&Frame, &BatchMin, &BatchMax, FirstVertex, NumVerts, bHeights](int32 BatchIndex)
+	{
+		const int32 BatchStart = FirstVertex + BatchIndex * BoundsBatchSize;
+		const int32 BatchCount = FMath::Min(BoundsBatchSize, FirstVertex + NumVerts - BatchStart);
+		if (bHeights)
+		{
+			ReduceHeightBounds(Frame.Heights.GetData() + BatchStart, BatchCount, BatchMin[BatchIndex], BatchMax[BatchIndex]);
+		}
+		else
+		{
+			ReducePositionBounds(Frame.Positions.GetData() + BatchStart, BatchCount, BatchMin[BatchIndex], BatchMax[BatchIndex]);
+		}
+	}, NumBatches <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	VectorRegister4Float Min = BatchMin[0];
+	VectorRegister4Float Max = BatchMax[0];
+	for (int32 BatchIndex = 1; BatchIndex < NumBatches; BatchIndex++)
+	{
+		Min = VectorMin(Min, BatchMin[BatchIndex]);
+		Max = VectorMax(Max, BatchMax[BatchIndex]);
+	}
+
+	FVector3f MinOut;
+	FVector3f MaxOut;
+	VectorStoreFloat3(Min, &MinOut.X);
+	VectorStoreFloat3(Max, &MaxOut.X);
+	if (bHeights)
+	{
+		return FBox(FVector(GridBounds.Min.X, GridBounds.Min.Y, MinOut.X), FVector(GridBounds.Max.X, GridBounds.Max.Y, MaxOut.X));
+	}
+	return FBox(FVector(MinOut), FVector(MaxOut));
+}
+
+// Per-frame streams are written with partial locks, which have to preserve the bytes outside the
+// locked range. Dynamic buffers may be renamed on lock (dropping their old contents), so these are
+// regular buffers written through the RHI's staging copy instead.
+// In height field mode the position and tangent streams are written by the expand compute shader instead,
+// so they also get a typed UAV.
+// Per-frame buffers are allocated for Capacity elements, which topology changes only grow (geometrically), so
+// switching between grid resolutions at runtime reuses the existing allocations where it can.
+
+// Next capacity for a per-frame buffer that has to hold Needed elements
+static int32 GrowBufferCapacity(int32 Capacity, int32 Needed)
+{
+	return FMath::Max(Needed, Capacity + Capacity / 2);
+}
+
 class FDirectProxyPositionBuffer : public FVertexBuffer
 {
 public:
 	int32 NumVertices = 0;
+	int32 Capacity = 0;
+	bool bQuantized = false;
+	bool bUnorderedAccess = false;
 	FShaderResourceViewRHIRef SRV;
+	FUnorderedAccessViewRHIRef UAV;
+
+	uint32 GetStride() const { return bQuantized ? sizeof(FDirectProxyQuantizedPosition) : sizeof(FVector3f); }
+	SIZE_T GetBufferSize() const { return static_cast<SIZE_T>(Capacity) * GetStride(); }
+
+	// Returns true when the buffer had to be reallocated; its contents are undefined either way
+	bool Resize(FRHICommandListBase& RHICmdList, int32 InNumVertices)
+	{
+		NumVertices = InNumVertices;
+		if (NumVertices <= Capacity)
+		{
+			return false;
+		}
+		Capacity = GrowBufferCapacity(Capacity, NumVertices);
+		UpdateRHI(RHICmdList);
+		return true;
+	}
 
 	virtual void InitRHI(FRHICommandListBase& RHICmdList) override
 	{
-		if (NumVertices > 0)
+		Capacity = FMath::Max(Capacity, NumVertices);
+		if (Capacity > 0)
 		{
 			const FRHIBufferCreateDesc Desc =
-				FRHIBufferCreateDesc::CreateVertex<FVector3f>(TEXT("DirectProxyPositionBuffer"), NumVertices)
-				.AddUsage(EBufferUsageFlags::Dynamic | EBufferUsageFlags::ShaderResource)
+				FRHIBufferCreateDesc::CreateVertex(TEXT("DirectProxyPositionBuffer"), Capacity * GetStride())
+				.SetStride(GetStride())
+				.AddUsage(EBufferUsageFlags::Static | EBufferUsageFlags::ShaderResource)
+				.AddUsage(bUnorderedAccess ? EBufferUsageFlags::UnorderedAccess : EBufferUsageFlags::None)
 				.DetermineInitialState();
 			VertexBufferRHI = RHICmdList.CreateBuffer(Desc);
 			SRV = RHICmdList.CreateShaderResourceView(VertexBufferRHI,
 				FRHIViewDesc::CreateBufferSRV()
 				.SetType(FRHIViewDesc::EBufferType::Typed)
-				.SetFormat(PF_R32_FLOAT));
+				.SetFormat(bQuantized ? PF_R16G16B16A16_UNORM : PF_R32_FLOAT));
+			if (bUnorderedAccess)
+			{
+				UAV = RHICmdList.CreateUnorderedAccessView(VertexBufferRHI,
+					FRHIViewDesc::CreateBufferUAV()
+					.SetType(FRHIViewDesc::EBufferType::Typed)
+					.SetFormat(PF_R32_FLOAT));
+			}
 		}
 	}
 
-	void UpdateData(FRHICommandListBase& RHICmdList, const TArray<FVector3f>& Data)
+	void UpdateData(FRHICommandListBase& RHICmdList, const FDirectProxyFrame& Frame)
 	{
-		if (!IsValidRef(VertexBufferRHI) || Data.Num() == 0)
+		UpdateRange(RHICmdList, Frame, 0, Frame.GetNumVertices());
+	}
+
+	// Uploads only vertices [FirstVertex, FirstVertex + Count), from the stream matching this buffer's format
+	void UpdateRange(FRHICommandListBase& RHICmdList, const FDirectProxyFrame& Frame, int32 FirstVertex, int32 Count)
+	{
+		if (!IsValidRef(VertexBufferRHI) || Count <= 0)
 		{
 			return;
 		}
-		void* Buffer = RHICmdList.LockBuffer(VertexBufferRHI, 0, Data.Num() * sizeof(FVector3f), RLM_WriteOnly);
-		FMemory::Memcpy(Buffer, Data.GetData(), Data.Num() * sizeof(FVector3f));
+		const uint8* Source = bQuantized
+			? reinterpret_cast<const uint8*>(Frame.QuantizedPositions.GetData())
+			: reinterpret_cast<const uint8*>(Frame.Positions.GetData());
+		check(!bQuantized || Frame.QuantizedPositions.Num() == Frame.GetNumVertices());
+		check(FirstVertex >= 0 && FirstVertex + Count <= FMath::Min(Frame.GetNumVertices(), NumVertices));
+
+		const uint32 Stride = GetStride();
+		void* Buffer = RHICmdList.LockBuffer(VertexBufferRHI, FirstVertex * Stride, Count * Stride, RLM_WriteOnly);
+		FMemory::Memcpy(Buffer, Source + FirstVertex * Stride, Count * Stride);
 		RHICmdList.UnlockBuffer(VertexBufferRHI);
 	}
 };
@@ -62,54 +568,68 @@ class FDirectProxyTangentBuffer : public FVertexBuffer
 {
 public:
 	int32 NumVertices = 0;
+	int32 Capacity = 0;
+	bool bUnorderedAccess = false;
 	FShaderResourceViewRHIRef SRV;
+	FUnorderedAccessViewRHIRef UAV;
+
+	SIZE_T GetBufferSize() const { return static_cast<SIZE_T>(Capacity) * 2 * sizeof(FPackedNormal); }
+
+	// Returns true when the buffer had to be reallocated; its contents are undefined either way
+	bool Resize(FRHICommandListBase& RHICmdList, int32 InNumVertices)
+	{
+		NumVertices = InNumVertices;
+		if (NumVertices <= Capacity)
+		{
+			return false;
+		}
+		Capacity = GrowBufferCapacity(Capacity, NumVertices);
+		UpdateRHI(RHICmdList);
+		return true;
+	}
 
 	virtual void InitRHI(FRHICommandListBase& RHICmdList) override
 	{
-		if (NumVertices > 0)
+		Capacity = FMath::Max(Capacity, NumVertices);
+		if (Capacity > 0)
 		{
 			// 2 x FPackedNormal per vertex (tangent + normal)
 			const FRHIBufferCreateDesc Desc =
-				FRHIBufferCreateDesc::CreateVertex(TEXT("DirectProxyTangentBuffer"), NumVertices * 2 * sizeof(FPackedNormal))
+				FRHIBufferCreateDesc::CreateVertex(TEXT("DirectProxyTangentBuffer"), Capacity * 2 * sizeof(FPackedNormal))
 				.SetStride(sizeof(FPackedNormal))
-				.AddUsage(EBufferUsageFlags::Dynamic | EBufferUsageFlags::ShaderResource)
+				.AddUsage(EBufferUsageFlags::Static | EBufferUsageFlags::ShaderResource)
+				.AddUsage(bUnorderedAccess ? EBufferUsageFlags::UnorderedAccess : EBufferUsageFlags::None)
 				.DetermineInitialState();
 			VertexBufferRHI = RHICmdList.CreateBuffer(Desc);
 			SRV = RHICmdList.CreateShaderResourceView(VertexBufferRHI,
 				FRHIViewDesc::CreateBufferSRV()
 				.SetType(FRHIViewDesc::EBufferType::Typed)
 				.SetFormat(PF_R8G8B8A8_SNORM));
+			if (bUnorderedAccess)
+			{
+				UAV = RHICmdList.CreateUnorderedAccessView(VertexBufferRHI,
+					FRHIViewDesc::CreateBufferUAV()
+					.SetType(FRHIViewDesc::EBufferType::Typed)
+					.SetFormat(PF_R8G8B8A8_SNORM));
+			}
 		}
 	}
 
-	void UpdateData(FRHICommandListBase& RHICmdList, const TArray<FVector3f>& Normals)
+	void UpdateData(FRHICommandListBase& RHICmdList, const TArray<FPackedNormal>& TangentBasis)
 	{
-		if (!IsValidRef(VertexBufferRHI) || Normals.Num() == 0)
-		{
-			return;
-		}
-		const int32 NumVerts = Normals.Num();
-		void* Buffer = RHICmdList.LockBuffer(VertexBufferRHI, 0, NumVerts * 2 * sizeof(FPackedNormal), RLM_WriteOnly);
-		FPackedNormal* TangentData = static_cast<FPackedNormal*>(Buffer);
+		UpdateRange(RHICmdList, TangentBasis, 0, TangentBasis.Num() / 2);
+	}
 
-		for (int32 i = 0; i < NumVerts; i++)
+	// Uploads only vertices [FirstVertex, FirstVertex + Count). The basis is already packed, so this is a plain copy.
+	void UpdateRange(FRHICommandListBase& RHICmdList, const TArray<FPackedNormal>& TangentBasis, int32 FirstVertex, int32 Count)
+	{
+		if (!IsValidRef(VertexBufferRHI) || Count <= 0)
 		{
-			const FVector3f& Normal = Normals[i];
-			FVector3f Tangent;
-			if (FMath::Abs(Normal.Z) < 0.999f)
-			{
-				Tangent = FVector3f::CrossProduct(FVector3f(0, 0, 1), Normal).GetSafeNormal();
-			}
-			else
-			{
-				Tangent = FVector3f::CrossProduct(FVector3f(1, 0, 0), Normal).GetSafeNormal();
-			}
-
-			TangentData[i * 2 + 0] = FPackedNormal(Tangent);
-			TangentData[i * 2 + 1] = FPackedNormal(Normal);
-			TangentData[i * 2 + 1].Vector.W = 127;
+			return;
 		}
-
+		check(FirstVertex >= 0 && FirstVertex + Count <= FMath::Min(TangentBasis.Num() / 2, NumVertices));
+		void* Buffer = RHICmdList.LockBuffer(VertexBufferRHI, FirstVertex * 2 * sizeof(FPackedNormal), Count * 2 * sizeof(FPackedNormal), RLM_WriteOnly);
+		FMemory::Memcpy(Buffer, TangentBasis.GetData() + FirstVertex * 2, Count * 2 * sizeof(FPackedNormal));
 		RHICmdList.UnlockBuffer(VertexBufferRHI);
 	}
 };
@@ -148,278 +668,1951 @@ public:
 	}
 };
 
-class FDirectProxyColorBuffer : public FVertexBuffer
+// Shader input for the height field expand pass: a typed buffer of NumElements elements, written in ranges
+class FDirectProxyTypedBuffer : public FVertexBuffer
 {
 public:
-	int32 NumVertices = 0;
+	FDirectProxyTypedBuffer(const TCHAR* InName, uint32 InStride, EPixelFormat InFormat)
+		: Name(InName)
+		, Stride(InStride)
+		, Format(InFormat)
+	{
+	}
+
+	int32 NumElements = 0;
+	int32 Capacity = 0;
 	FShaderResourceViewRHIRef SRV;
 
+	SIZE_T GetBufferSize() const { return static_cast<SIZE_T>(Capacity) * Stride; }
+
+	// Returns true when the buffer had to be reallocated; its contents are undefined either way
+	bool Resize(FRHICommandListBase& RHICmdList, int32 InNumElements)
+	{
+		NumElements = InNumElements;
+		if (NumElements <= Capacity)
+		{
+			return false;
+		}
+		Capacity = GrowBufferCapacity(Capacity, NumElements);
+		UpdateRHI(RHICmdList);
+		return true;
+	}
+
 	virtual void InitRHI(FRHICommandListBase& RHICmdList) override
 	{
-		if (NumVertices > 0)
+		Capacity = FMath::Max(Capacity, NumElements);
+		if (Capacity > 0)
 		{
 			const FRHIBufferCreateDesc Desc =
-				FRHIBufferCreateDesc::CreateVertex<FColor>(TEXT("DirectProxyColorBuffer"), NumVertices)
+				FRHIBufferCreateDesc::CreateVertex(Name, Capacity * Stride)
+				.SetStride(Stride)
 				.AddUsage(EBufferUsageFlags::Static | EBufferUsageFlags::ShaderResource)
 				.DetermineInitialState();
 			VertexBufferRHI = RHICmdList.CreateBuffer(Desc);
 			SRV = RHICmdList.CreateShaderResourceView(VertexBufferRHI,
 				FRHIViewDesc::CreateBufferSRV()
 				.SetType(FRHIViewDesc::EBufferType::Typed)
-				.SetFormat(PF_R8G8B8A8));
+				.SetFormat(Format));
+		}
+	}
 
-			void* Buffer = RHICmdList.LockBuffer(VertexBufferRHI, 0, NumVertices * sizeof(FColor), RLM_WriteOnly);
-			FMemory::Memset(Buffer, 0xFF, NumVertices * sizeof(FColor));
-			RHICmdList.UnlockBuffer(VertexBufferRHI);
+	// Uploads elements [First, First + Count) from Data, which holds all NumElements elements
+	void UpdateRange(FRHICommandListBase& RHICmdList, const void* Data, int32 First, int32 Count)
+	{
+		if (!IsValidRef(VertexBufferRHI) || Count <= 0)
+		{
+			return;
 		}
+		check(First >= 0 && First + Count <= NumElements);
+		void* Buffer = RHICmdList.LockBuffer(VertexBufferRHI, First * Stride, Count * Stride, RLM_WriteOnly);
+		FMemory::Memcpy(Buffer, static_cast<const uint8*>(Data) + First * Stride, Count * Stride);
+		RHICmdList.UnlockBuffer(VertexBufferRHI);
 	}
+
+private:
+	const TCHAR* Name;
+	uint32 Stride;
+	EPixelFormat Format;
 };
 
-class FDirectProxyIndexBuffer : public FIndexBuffer
+// Static per-vertex colors, only created for topologies that come with colors. Everything else binds the
+// engine's shared null color buffer (stride 0, white), which costs nothing per vertex.
+class FDirectProxyColorBuffer : public FVertexBuffer
 {
 public:
-	int32 NumIndices = 0;
+	int32 NumVertices = 0;
+	FShaderResourceViewRHIRef SRV;
 
 	virtual void InitRHI(FRHICommandListBase& RHICmdList) override
 	{
-		if (NumIndices > 0)
+		if (NumVertices > 0)
 		{
 			const FRHIBufferCreateDesc Desc =
-				FRHIBufferCreateDesc::CreateIndex<uint32>(TEXT("DirectProxyIndexBuffer"), NumIndices)
-				.AddUsage(EBufferUsageFlags::Static)
+				FRHIBufferCreateDesc::CreateVertex<FColor>(TEXT("DirectProxyColorBuffer"), NumVertices)
+				.AddUsage(EBufferUsageFlags::Static | EBufferUsageFlags::ShaderResource)
 				.DetermineInitialState();
-			IndexBufferRHI = RHICmdList.CreateBuffer(Desc);
+			VertexBufferRHI = RHICmdList.CreateBuffer(Desc);
+			SRV = RHICmdList.CreateShaderResourceView(VertexBufferRHI,
+				FRHIViewDesc::CreateBufferSRV()
+				.SetType(FRHIViewDesc::EBufferType::Typed)
+				.SetFormat(PF_R8G8B8A8));
 		}
 	}
 
-	void SetData(FRHICommandListBase& RHICmdList, const TArray<uint32>& Data)
+	void SetData(FRHICommandListBase& RHICmdList, const TArray<FColor>& Data)
 	{
-		if (!IsValidRef(IndexBufferRHI) || Data.Num() == 0)
+		if (!IsValidRef(VertexBufferRHI) || Data.Num() == 0)
 		{
 			return;
 		}
-		void* Buffer = RHICmdList.LockBuffer(IndexBufferRHI, 0, Data.Num() * sizeof(uint32), RLM_WriteOnly);
-		FMemory::Memcpy(Buffer, Data.GetData(), Data.Num() * sizeof(uint32));
-		RHICmdList.UnlockBuffer(IndexBufferRHI);
+		void* Buffer = RHICmdList.LockBuffer(VertexBufferRHI, 0, Data.Num() * sizeof(FColor), RLM_WriteOnly);
+		FMemory::Memcpy(Buffer, Data.GetData(), Data.Num() * sizeof(FColor));
+		RHICmdList.UnlockBuffer(VertexBufferRHI);
 	}
 };
 
-// ============================================================================
-// Scene Proxy
-// ============================================================================
+// A range of the index buffer drawn as one batch. 16-bit indices are relative to BaseVertexIndex.
+// Chunks never cross sections, so each one is drawn with its section's material.
+struct FDirectProxyIndexChunk
+{
+	int32 SectionIndex = 0;
+	int32 FirstIndex = 0;
+	int32 NumIndices = 0;
+	uint32 BaseVertexIndex = 0;
+	uint32 MinVertexIndex = 0;
+	uint32 MaxVertexIndex = 0;
+};
 
-class FDirectProxyMeshSceneProxy : public FPrimitiveSceneProxy
+// Splits one section into chunks whose vertex span fits 16-bit indices
+static bool BuildSectionIndexChunks16(const TArray<uint32>& Indices, int32 SectionIndex, const FDirectProxyMeshSection& Section, TArray<FDirectProxyIndexChunk>& OutChunks)
 {
-public:
-	FDirectProxyMeshSceneProxy(UDirectProxyMeshComponent* Component,
-		const TArray<uint32>& InIndices,
-		const TArray<FVector2f>& InTexCoords,
-		const TArray<FVector3f>& InPositions,
-		const TArray<FVector3f>& InNormals,
-		UMaterialInterface* InMaterial)
-		: FPrimitiveSceneProxy(Component)
-		, VertexFactory(GetScene().GetFeatureLevel(), "FDirectProxyMeshVertexFactory")
-		, Material(InMaterial)
-		, MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetShaderPlatform()))
+	FDirectProxyIndexChunk Chunk;
+	Chunk.SectionIndex = SectionIndex;
+	Chunk.FirstIndex = Section.FirstIndex;
+	Chunk.MinVertexIndex = MAX_uint32;
+	for (int32 i = Section.FirstIndex; i + 2 < Section.FirstIndex + Section.NumIndices; i += 3)
 	{
-		const int32 NumVerts = InPositions.Num();
-		const int32 NumIdx = InIndices.Num();
-
-		PositionBuffer.NumVertices = NumVerts;
-		TangentBuffer.NumVertices = NumVerts;
-		TexCoordBuffer.NumVertices = NumVerts;
-		ColorBuffer.NumVertices = NumVerts;
-		IndexBuffer.NumIndices = NumIdx;
+		const uint32 TriMin = FMath::Min3(Indices[i], Indices[i + 1], Indices[i + 2]);
+		const uint32 TriMax = FMath::Max3(Indices[i], Indices[i + 1], Indices[i + 2]);
+		if (TriMax - TriMin > MAX_uint16)
+		{
+			return false;
+		}
+
+		const uint32 NewMin = FMath::Min(Chunk.MinVertexIndex, TriMin);
+		const uint32 NewMax = FMath::Max(Chunk.MaxVertexIndex, TriMax);
+		if (Chunk.NumIndices > 0 && NewMax - NewMin > MAX_uint16)
+		{
+			OutChunks.Add(Chunk);
+			Chunk.FirstIndex = i;
+			Chunk.NumIndices = 0;
+			Chunk.MinVertexIndex = TriMin;
+			Chunk.MaxVertexIndex = TriMax;
+		}
+		else
+		{
+			Chunk.MinVertexIndex = NewMin;
+			Chunk.MaxVertexIndex = NewMax;
+		}
+		Chunk.NumIndices += 3;
+	}
+	if (Chunk.NumIndices > 0)
+	{
+		OutChunks.Add(Chunk);
+	}
+	return true;
+}
+
+// Converts indices to 16 bits. Each section's triangles are split greedily, in order, into chunks spanning at most
+// 65536 vertices, and each chunk's indices are stored relative to its lowest vertex. Sections of meshes below 65536
+// vertices end up as one chunk each. Returns false when a single triangle spans too many vertices, in which case
+// the mesh has to stay 32-bit.
+static bool BuildIndexChunks16(const TArray<uint32>& Indices, TConstArrayView<FDirectProxyMeshSection> Sections, TArray<uint16>& OutIndices, TArray<FDirectProxyIndexChunk>& OutChunks)
+{
+	OutChunks.Reset();
+	for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); SectionIndex++)
+	{
+		if (!BuildSectionIndexChunks16(Indices, SectionIndex, Sections[SectionIndex], OutChunks))
+		{
+			return false;
+		}
+	}
+
+	OutIndices.SetNumZeroed(Indices.Num());
+	for (FDirectProxyIndexChunk& OutChunk : OutChunks)
+	{
+		OutChunk.BaseVertexIndex = OutChunk.MinVertexIndex;
+		for (int32 i = OutChunk.FirstIndex; i < OutChunk.FirstIndex + OutChunk.NumIndices; i++)
+		{
+			OutIndices[i] = static_cast<uint16>(Indices[i] - OutChunk.BaseVertexIndex);
+		}
+	}
+	return true;
+}
+
+class FDirectProxyIndexBuffer : public FIndexBuffer
+{
+public:
+	int32 NumIndices = 0;
+	bool b32Bit = false;
+
+	uint32 GetStride() const { return b32Bit ? sizeof(uint32) : sizeof(uint16); }
+
+	virtual void InitRHI(FRHICommandListBase& RHICmdList) override
+	{
+		if (NumIndices > 0)
+		{
+			const FRHIBufferCreateDesc Desc =
+				FRHIBufferCreateDesc::CreateIndex(TEXT("DirectProxyIndexBuffer"), NumIndices * GetStride())
+				.SetStride(GetStride())
+				.AddUsage(EBufferUsageFlags::Static)
+				.DetermineInitialState();
+			IndexBufferRHI = RHICmdList.CreateBuffer(Desc);
+		}
+	}
+
+	// Data holds NumIndices indices of GetStride() bytes each
+	void SetData(FRHICommandListBase& RHICmdList, const void* Data)
+	{
+		if (!IsValidRef(IndexBufferRHI) || NumIndices == 0)
+		{
+			return;
+		}
+		void* Buffer = RHICmdList.LockBuffer(IndexBufferRHI, 0, NumIndices * GetStride(), RLM_WriteOnly);
+		FMemory::Memcpy(Buffer, Data, NumIndices * GetStride());
+		RHICmdList.UnlockBuffer(IndexBufferRHI);
+	}
+};
+
+// ============================================================================
+// Shared Topology
+// ============================================================================
+
+// Immutable indices, UVs, colors and grid X/Y plus the GPU buffers built from them (index, UV, color, grid X/Y).
+// Components with identical data share one instance through FDirectProxyTopologyRegistry; the scene proxies
+// hold references too, so the buffers stay alive until the last proxy drawing them is gone.
+class FDirectProxyTopology
+{
+public:
+	FDirectProxyTopology(FDirectProxyLODTopology&& InTopology, uint32 InHash)
+		: Indices(MoveTemp(InTopology.Indices))
+		, TexCoords(MoveTemp(InTopology.TexCoords))
+		, Colors(MoveTemp(InTopology.Colors))
+		, GridXY(MoveTemp(InTopology.GridXY))
+		, Sections(MoveTemp(InTopology.Sections))
+		, NumVertices(InTopology.NumVertices)
+		, Hash(InHash)
+	{
+		// Vertices referenced by each section, for per-section dirty updates
+		for (const FDirectProxyMeshSection& Section : Sections)
+		{
+			int32 MinVertex = NumVertices;
+			int32 MaxVertex = -1;
+			for (int32 i = Section.FirstIndex; i < Section.FirstIndex + Section.NumIndices; i++)
+			{
+				MinVertex = FMath::Min(MinVertex, static_cast<int32>(Indices[i]));
+				MaxVertex = FMath::Max(MaxVertex, static_cast<int32>(Indices[i]));
+			}
+			SectionVertexRanges.Emplace(FMath::Min(MinVertex, MaxVertex + 1), FMath::Max(MaxVertex + 1 - MinVertex, 0));
+		}
+
+		TexCoordBuffer.NumVertices = NumVertices;
+		ColorBuffer.NumVertices = Colors.Num();
+		IndexBuffer.NumIndices = Indices.Num();
+		GridXYBuffer.NumElements = GridXY.Num();
+		GridBounds = GridXY.Num() > 0 ? FBox2f(GridXY.GetData(), GridXY.Num()) : FBox2f(ForceInit);
+
+		// 16-bit indices wherever every chunk fits, which halves index memory and fetch bandwidth
+		TArray<uint16> Indices16;
+		if (BuildIndexChunks16(Indices, Sections, Indices16, IndexChunks))
+		{
+			IndexBuffer.b32Bit = false;
+			CachedIndexData.SetNumUninitialized(Indices16.Num() * sizeof(uint16));
+			FMemory::Memcpy(CachedIndexData.GetData(), Indices16.GetData(), CachedIndexData.Num());
+		}
+		else
+		{
+			IndexBuffer.b32Bit = true;
+			CachedIndexData.SetNumUninitialized(Indices.Num() * sizeof(uint32));
+			FMemory::Memcpy(CachedIndexData.GetData(), Indices.GetData(), CachedIndexData.Num());
+
+			IndexChunks.Reset();
+			for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); SectionIndex++)
+			{
+				if (Sections[SectionIndex].NumIndices == 0)
+				{
+					continue;
+				}
+				FDirectProxyIndexChunk& Chunk = IndexChunks.AddDefaulted_GetRef();
+				Chunk.SectionIndex = SectionIndex;
+				Chunk.FirstIndex = Sections[SectionIndex].FirstIndex;
+				Chunk.NumIndices = Sections[SectionIndex].NumIndices;
+				Chunk.MinVertexIndex = SectionVertexRanges[SectionIndex].FirstVertex;
+				Chunk.MaxVertexIndex = FMath::Max(SectionVertexRanges[SectionIndex].FirstVertex + SectionVertexRanges[SectionIndex].NumVertices - 1, 0);
+			}
+		}
+
+		// The cached index data is freed once uploaded, so it isn't counted
+		CPUMemorySize = sizeof(*this) + Indices.GetAllocatedSize() + TexCoords.GetAllocatedSize() + Colors.GetAllocatedSize() + GridXY.GetAllocatedSize()
+			+ Sections.GetAllocatedSize() + SectionVertexRanges.GetAllocatedSize() + IndexChunks.GetAllocatedSize();
+		VertexBufferMemorySize = NumVertices * sizeof(FVector2f) + Colors.Num() * sizeof(FColor) + GridXY.Num() * sizeof(FVector2f);
+		GPUMemorySize = Indices.Num() * IndexBuffer.GetStride() + VertexBufferMemorySize;
+		MemorySize = CPUMemorySize + GPUMemorySize;
+		INC_DWORD_STAT(STAT_DirectProxyMesh_NumTopologies);
+		INC_MEMORY_STAT_BY(STAT_DirectProxyMesh_TopologyUniqueMemory, MemorySize);
+	}
+
+	~FDirectProxyTopology()
+	{
+		check(NumUsers == 0);
+		DEC_DWORD_STAT(STAT_DirectProxyMesh_NumTopologies);
+		DEC_MEMORY_STAT_BY(STAT_DirectProxyMesh_TopologyUniqueMemory, MemorySize);
+		if (bResourcesInitialized)
+		{
+			DEC_MEMORY_STAT_BY(STAT_DirectProxyMesh_TopologyGPUMemory, GPUMemorySize);
+		}
+
+		TexCoordBuffer.ReleaseResource();
+		ColorBuffer.ReleaseResource();
+		IndexBuffer.ReleaseResource();
+		GridXYBuffer.ReleaseResource();
+	}
+
+	// Only the sections' index ranges are part of the topology; materials and visibility belong to each component
+	bool Matches(const FDirectProxyLODTopology& In) const
+	{
+		if (NumVertices != In.NumVertices || Sections.Num() != In.Sections.Num())
+		{
+			return false;
+		}
+		for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); SectionIndex++)
+		{
+			if (Sections[SectionIndex].FirstIndex != In.Sections[SectionIndex].FirstIndex || Sections[SectionIndex].NumIndices != In.Sections[SectionIndex].NumIndices)
+			{
+				return false;
+			}
+		}
+		return Indices == In.Indices && TexCoords == In.TexCoords && Colors == In.Colors && GridXY == In.GridXY;
+	}
+
+	// Called by every proxy; only the first call creates and fills the buffers
+	void InitResources_RenderThread(FRHICommandListBase& RHICmdList)
+	{
+		FScopeLock Lock(&InitCriticalSection);
+		if (bResourcesInitialized)
+		{
+			return;
+		}
+		bResourcesInitialized = true;
+		LLM_SCOPE_BYTAG(DirectProxyMesh);
+		INC_MEMORY_STAT_BY(STAT_DirectProxyMesh_TopologyGPUMemory, GPUMemorySize);
+
+		TexCoordBuffer.InitResource(RHICmdList);
+		ColorBuffer.InitResource(RHICmdList);
+		IndexBuffer.InitResource(RHICmdList);
+		GridXYBuffer.InitResource(RHICmdList);
+
+		TexCoordBuffer.SetData(RHICmdList, TexCoords);
+		ColorBuffer.SetData(RHICmdList, Colors);
+		IndexBuffer.SetData(RHICmdList, CachedIndexData.GetData());
+		GridXYBuffer.UpdateRange(RHICmdList, GridXY.GetData(), 0, GridXY.Num());
+
+		// The GPU copy is all that's needed from here on; the 32-bit indices stay for matching
+		CachedIndexData.Empty();
+	}
+
+	// Components using this topology, for the sharing stats
+	void AddUser()
+	{
+		if (++NumUsers > 1)
+		{
+			INC_MEMORY_STAT_BY(STAT_DirectProxyMesh_TopologySharedMemory, MemorySize);
+		}
+	}
+
+	void RemoveUser()
+	{
+		if (NumUsers-- > 1)
+		{
+			DEC_MEMORY_STAT_BY(STAT_DirectProxyMesh_TopologySharedMemory, MemorySize);
+		}
+	}
+
+	int32 GetNumUsers() const { return NumUsers; }
+
+	// CPU arrays kept for matching and section queries, and the GPU buffers built from them
+	SIZE_T GetCPUMemorySize() const { return CPUMemorySize; }
+	SIZE_T GetGPUMemorySize() const { return GPUMemorySize; }
+
+	// GPU bytes of the per-vertex buffers alone (UVs, colors, grid X/Y), without the indices
+	SIZE_T GetVertexBufferMemorySize() const { return VertexBufferMemorySize; }
+
+	const TArray<uint32> Indices;
+	const TArray<FVector2f> TexCoords;
+	const TArray<FColor> Colors;
+	const TArray<FVector2f> GridXY;
+	const TArray<FDirectProxyMeshSection> Sections;
+	TArray<FDirectProxyDirtyRange> SectionVertexRanges;
+	const int32 NumVertices;
+	const uint32 Hash;
+
+	// X/Y extent of the grid, for automatic bounds of height field frames
+	FBox2f GridBounds;
+
+	FDirectProxyTexCoordBuffer TexCoordBuffer;
+	FDirectProxyColorBuffer ColorBuffer;
+	FDirectProxyIndexBuffer IndexBuffer;
+	TArray<FDirectProxyIndexChunk> IndexChunks;
+
+	// Static X/Y for height field expansion, only created for grid topologies
+	FDirectProxyTypedBuffer GridXYBuffer{TEXT("DirectProxyGridXYBuffer"), sizeof(FVector2f), PF_G32R32F};
+
+private:
+	TArray<uint8> CachedIndexData;
+	FCriticalSection InitCriticalSection;
+	bool bResourcesInitialized = false;
+	std::atomic<int32> NumUsers = 0;
+	SIZE_T CPUMemorySize = 0;
+	SIZE_T GPUMemorySize = 0;
+	SIZE_T VertexBufferMemorySize = 0;
+	SIZE_T MemorySize = 0;
+};
+
+// Maps topology hashes to live topologies. Only weak references are kept, so a topology goes away with its last user.
+class FDirectProxyTopologyRegistry
+{
+public:
+	static FDirectProxyTopologyRegistry& Get()
+	{
+		static FDirectProxyTopologyRegistry Registry;
+		return Registry;
+	}
+
+	// Takes the LOD's indices, UVs, colors, grid X/Y and sections; the screen size isn't part of the topology
+	FDirectProxyTopologyRef FindOrCreate(FDirectProxyLODTopology&& In)
+	{
+		uint32 Hash = FCrc::MemCrc32(In.Indices.GetData(), In.Indices.Num() * sizeof(uint32));
+		Hash = FCrc::MemCrc32(In.TexCoords.GetData(), In.TexCoords.Num() * sizeof(FVector2f), Hash);
+		Hash = FCrc::MemCrc32(In.Colors.GetData(), In.Colors.Num() * sizeof(FColor), Hash);
+		Hash = FCrc::MemCrc32(In.GridXY.GetData(), In.GridXY.Num() * sizeof(FVector2f), Hash);
+		Hash = HashCombine(Hash, ::GetTypeHash(In.NumVertices));
+		for (const FDirectProxyMeshSection& Section : In.Sections)
+		{
+			Hash = HashCombine(Hash, HashCombine(::GetTypeHash(Section.FirstIndex), ::GetTypeHash(Section.NumIndices)));
+		}
+
+		LLM_SCOPE_BYTAG(DirectProxyMesh);
+
+		// Pinned candidates are released after the lock, since dropping the last reference re-enters Remove()
+		TArray<FDirectProxyTopologyPtr, TInlineAllocator<4>> Candidates;
+		FScopeLock Lock(&CriticalSection);
+		TArray<TWeakPtr<FDirectProxyTopology, ESPMode::ThreadSafe>>& Entries = Topologies.FindOrAdd(Hash);
+		for (const TWeakPtr<FDirectProxyTopology, ESPMode::ThreadSafe>& Entry : Entries)
+		{
+			if (FDirectProxyTopologyPtr Existing = Entry.Pin())
+			{
+				Candidates.Add(Existing);
+				if (Existing->Matches(In))
+				{
+					return Existing.ToSharedRef();
+				}
+			}
+		}
+
+		// The last reference is usually dropped by a scene proxy on the render thread, but a component that never
+		// got a proxy drops it on the game thread. Either way the buffers are released on the render thread.
+		FDirectProxyTopologyRef Topology = MakeShareable(
+			new FDirectProxyTopology(MoveTemp(In), Hash),
+			[](FDirectProxyTopology* InTopology)
+			{
+				FDirectProxyTopologyRegistry::Get().Remove(InTopology->Hash);
+				if (IsInRenderingThread())
+				{
+					delete InTopology;
+				}
+				else
+				{
+					ENQUEUE_RENDER_COMMAND(ReleaseDirectProxyTopology)(
+						[InTopology](FRHICommandListImmediate& RHICmdList)
+						{
+							delete InTopology;
+						}
+					);
+				}
+			});
+		Entries.Add(Topology);
+		return Topology;
+	}
+
+private:
+	// Drops the expired entries for a hash
+	void Remove(uint32 Hash)
+	{
+		FScopeLock Lock(&CriticalSection);
+		if (TArray<TWeakPtr<FDirectProxyTopology, ESPMode::ThreadSafe>>* Entries = Topologies.Find(Hash))
+		{
+			Entries->RemoveAll([](const TWeakPtr<FDirectProxyTopology, ESPMode::ThreadSafe>& Entry) { return !Entry.IsValid(); });
+			if (Entries->Num() == 0)
+			{
+				Topologies.Remove(Hash);
+			}
+		}
+	}
+
+	FCriticalSection CriticalSection;
+	TMap<uint32, TArray<TWeakPtr<FDirectProxyTopology, ESPMode::ThreadSafe>>> Topologies;
+};
+
+// ============================================================================
+// Scene Proxy
+// ============================================================================
+
+// Written by scene proxies while computing view relevance and read by the component, so producers
+// know which LOD to generate. Shared so it outlives whichever side goes away first.
+struct FDirectProxyLODFeedback
+{
+	// Finest LOD needed by any view in the most recent frame
+	std::atomic<int32> RequiredLOD{0};
+	std::atomic<uint32> FrameNumber{0};
+
+	void ReportView(uint32 InFrameNumber, int32 LOD)
+	{
+		// The first view of a new frame starts over, so the requirement can get coarser again
+		if (FrameNumber.exchange(InFrameNumber, std::memory_order_relaxed) != InFrameNumber)
+		{
+			RequiredLOD.store(LOD, std::memory_order_relaxed);
+			return;
+		}
+		int32 Current = RequiredLOD.load(std::memory_order_relaxed);
+		while (LOD < Current && !RequiredLOD.compare_exchange_weak(Current, LOD, std::memory_order_relaxed))
+		{
+		}
+	}
+};
+
+class FDirectProxyMeshSceneProxy : public FPrimitiveSceneProxy
+{
+public:
+	FDirectProxyMeshSceneProxy(UDirectProxyMeshComponent* Component,
+		TConstArrayView<FDirectProxyTopologyRef> InTopologies,
+		TConstArrayView<float> InScreenSizes,
+		const FDirectProxyFrameRef& InFrame,
+		const TSharedRef<FDirectProxyLODFeedback, ESPMode::ThreadSafe>& InLODFeedback)
+		: FPrimitiveSceneProxy(Component)
+		, MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetShaderPlatform()))
+		, LODFeedback(InLODFeedback)
+		, FeatureLevel(GetScene().GetFeatureLevel())
+		, bHeightField(InFrame->Layout == EDirectProxyFrameLayout::Heights)
+		, bStaticDrawPath(CVarDirectProxyStaticDrawIdleFrames.GetValueOnAnyThread() > 0)
+		, VertexStreams(Component->GetVertexStreams())
+	{
+		LLM_SCOPE_BYTAG(DirectProxyMesh);
+		const int32 NumSlots = GetNumBufferedFrames();
+
+		for (int32 LODIndex = 0; LODIndex < InTopologies.Num(); LODIndex++)
+		{
+			FLODRenderData* LOD = new FLODRenderData(InTopologies[LODIndex]);
+			LOD->NumVertices = LOD->Topology->NumVertices;
+			LOD->ScreenSize = InScreenSizes[LODIndex];
+
+			for (int32 SlotIndex = 0; SlotIndex < NumSlots; SlotIndex++)
+			{
+				FDirectProxyVertexSlot* Slot = new FDirectProxyVertexSlot(FeatureLevel);
+				Slot->PositionBuffer.NumVertices = LOD->NumVertices;
+				Slot->PositionBuffer.bQuantized = InFrame->Layout == EDirectProxyFrameLayout::QuantizedPositions;
+				Slot->PositionBuffer.bUnorderedAccess = bHeightField;
+				Slot->TangentBuffer.NumVertices = LOD->NumVertices;
+				Slot->TangentBuffer.bUnorderedAccess = bHeightField;
+				LOD->VertexSlots.Add(Slot);
+			}
+
+			if (bHeightField)
+			{
+				LOD->HeightBuffer.NumElements = LOD->NumVertices;
+				LOD->PackedNormalBuffer.NumElements = LOD->NumVertices;
+			}
+			LODs.Add(LOD);
+		}
+
+		// Materials and visibility are per component, even when the topology is shared
+		const TArray<FDirectProxyMeshSection>& ComponentSections = Component->GetSections();
+		for (const FDirectProxyMeshSection& Section : ComponentSections)
+		{
+			FSectionDrawInfo& DrawInfo = Sections.AddDefaulted_GetRef();
+			DrawInfo.Material = Component->GetMaterial(Section.MaterialIndex);
+			if (!DrawInfo.Material)
+			{
+				DrawInfo.Material = UMaterial::GetDefaultMaterial(MD_Surface);
+			}
+			DrawInfo.bVisible = Section.bVisible;
+		}
+
+		// The frame and topology are shared rather than copied; the frame is released once uploaded.
+		// Only the LOD it belongs to starts out with data; the others are filled when the producer gets to them.
+		InitialFrame = InFrame;
+		LatestLOD = InFrame->LODIndex;
+
+		if (bHeightField)
+		{
+			const int32 NumVerts = InFrame->GetNumVertices();
+			const TArray<FVector2f>& GridXY = LODs[LatestLOD].Topology->GridXY;
+
+			// Resource creation can't dispatch compute work, so slot 0 starts from a CPU expansion of the first frame.
+			// Later frames only upload heights and normals and are expanded on the GPU.
+			FDirectProxyFrameRef Expanded = MakeShared<FDirectProxyFrame, ESPMode::ThreadSafe>();
+			FDirectProxyFramePool::SizeFrame(*Expanded, NumVerts, EDirectProxyFrameLayout::Positions);
+			for (int32 i = 0; i < NumVerts; i++)
+			{
+				Expanded->Positions[i] = FVector3f(GridXY[i].X, GridXY[i].Y, InFrame->Heights[i]);
+			}
+			FMemory::Memcpy(Expanded->Normals.GetData(), InFrame->Normals.GetData(), NumVerts * sizeof(FVector3f));
+			PrepareFrameParallel(*Expanded, 0, NumVerts, nullptr);
+			InitialExpandedFrame = Expanded;
+		}
+	}
+
+	virtual ~FDirectProxyMeshSceneProxy()
+	{
+		DEC_MEMORY_STAT_BY(STAT_DirectProxyMesh_VertexStreamMemory, VertexStreamMemorySize.load());
+		for (FLODRenderData& LOD : LODs)
+		{
+			for (FDirectProxyVertexSlot& Slot : LOD.VertexSlots)
+			{
+				Slot.PositionBuffer.ReleaseResource();
+				Slot.TangentBuffer.ReleaseResource();
+				Slot.VertexFactory.ReleaseResource();
+			}
+			LOD.HeightBuffer.ReleaseResource();
+			LOD.PackedNormalBuffer.ReleaseResource();
+		}
+	}
+
+	virtual void CreateRenderThreadResources(FRHICommandListBase& RHICmdList) override
+	{
+		LLM_SCOPE_BYTAG(DirectProxyMesh);
+
+		for (FLODRenderData& LOD : LODs)
+		{
+			// Index, UV and color buffers are shared with every other proxy using the same topology
+			LOD.Topology->InitResources_RenderThread(RHICmdList);
+
+			if (bHeightField)
+			{
+				LOD.HeightBuffer.InitResource(RHICmdList);
+				LOD.PackedNormalBuffer.InitResource(RHICmdList);
+			}
+
+			// Every slot gets its own vertex factory bound to its own position/tangent streams,
+			// so switching slots is just a matter of drawing with a different factory.
+			for (FDirectProxyVertexSlot& Slot : LOD.VertexSlots)
+			{
+				Slot.PositionBuffer.InitResource(RHICmdList);
+				Slot.TangentBuffer.InitResource(RHICmdList);
+				SetVertexFactoryData(RHICmdList, LOD, Slot);
+				Slot.VertexFactory.InitResource(RHICmdList);
+			}
+		}
+		UpdateVertexStreamMemoryStat();
+
+		// Initial data goes into slot 0 of its LOD; the other slots are only drawn after they have been written
+		FLODRenderData& LOD = LODs[LatestLOD];
+		if (bHeightField)
+		{
+			// The expand inputs always hold the latest frame, so any slot can be rebuilt from them
+			LOD.HeightBuffer.UpdateRange(RHICmdList, InitialFrame->Heights.GetData(), 0, LOD.NumVertices);
+			LOD.PackedNormalBuffer.UpdateRange(RHICmdList, InitialFrame->PackedNormals.GetData(), 0, LOD.NumVertices);
+			LOD.bInputsValid = true;
+		}
+		LOD.CurrentSlot = 0;
+		UploadToSlot(RHICmdList, LOD.VertexSlots[LOD.CurrentSlot], bHeightField ? *InitialExpandedFrame : *InitialFrame);
+		LOD.VertexSlots[LOD.CurrentSlot].bFullUploadPending = false;
+		LOD.UpdateSerial = ++LatestSerial;
+
+		InitialFrame.Reset();
+		InitialExpandedFrame.Reset();
+	}
+
+	// Called before a topology update is enqueued: frames in the mailbox were built for the old topology, and the
+	// update command already queued (if any) runs before the topology changes, so later frames need a new one.
+	// Frames posted from now on carry the returned topology generation, which that stale command leaves alone.
+	// Sets bOutDiscarded if there was anything to discard.
+	uint32 DiscardPendingUpdates_GameThread(bool& bOutDiscarded)
+	{
+		FScopeLock Lock(&MailboxCriticalSection);
+		bOutDiscarded = PendingUpdates.Num() > 0;
+		PendingUpdates.Reset();
+		bUpdateCommandQueued = false;
+		return ++MailboxTopologyGeneration;
+	}
+
+	// Swaps in new topologies without recreating the proxy. Vertex streams are resized in place and only reallocated
+	// when they outgrow their capacity. LODs whose vertex count changed draw nothing until their next frame arrives.
+	void UpdateTopology_RenderThread(FRHICommandListImmediate& RHICmdList, TConstArrayView<FDirectProxyTopologyRef> InTopologies, TConstArrayView<float> InScreenSizes, uint32 InTopologyGeneration)
+	{
+		LLM_SCOPE_BYTAG(DirectProxyMesh);
+		check(InTopologies.Num() == LODs.Num());
+		TopologyGeneration = InTopologyGeneration;
+
+		for (int32 LODIndex = 0; LODIndex < LODs.Num(); LODIndex++)
+		{
+			FLODRenderData& LOD = LODs[LODIndex];
+			LOD.ScreenSize = InScreenSizes[LODIndex];
+			if (LOD.Topology == InTopologies[LODIndex])
+			{
+				continue;
+			}
+
+			LOD.Topology = InTopologies[LODIndex];
+			LOD.Topology->InitResources_RenderThread(RHICmdList);
+
+			const bool bResized = LOD.NumVertices != LOD.Topology->NumVertices;
+			LOD.NumVertices = LOD.Topology->NumVertices;
+			if (bHeightField)
+			{
+				LOD.HeightBuffer.Resize(RHICmdList, LOD.NumVertices);
+				LOD.PackedNormalBuffer.Resize(RHICmdList, LOD.NumVertices);
+			}
+
+			for (FDirectProxyVertexSlot& Slot : LOD.VertexSlots)
+			{
+				Slot.PositionBuffer.Resize(RHICmdList, LOD.NumVertices);
+				Slot.TangentBuffer.Resize(RHICmdList, LOD.NumVertices);
+				Slot.PendingRanges.Reset();
+				Slot.bFullUploadPending = true;
+
+				// UVs and colors come from the new topology, and reallocated streams have new SRVs
+				SetVertexFactoryData(RHICmdList, LOD, Slot);
+			}
+
+			if (bResized)
+			{
+				// The old vertex data doesn't fit the new topology
+				LOD.bInputsValid = false;
+				LOD.UpdateSerial = 0;
+			}
+			else if (bHeightField && LOD.bInputsValid)
+			{
+				// Same heights, but the grid X/Y may have moved
+				ExpandToSlot(RHICmdList, LOD, LOD.VertexSlots[LOD.CurrentSlot], {});
+				LOD.VertexSlots[LOD.CurrentSlot].bFullUploadPending = false;
+			}
+			else if (LOD.UpdateSerial != 0)
+			{
+				// The current slot still holds valid vertices for this vertex count
+				LOD.VertexSlots[LOD.CurrentSlot].bFullUploadPending = false;
+			}
+		}
+
+		UpdateVertexStreamMemoryStat();
+
+		// Cached draw commands reference the old index buffers and vertex factories
+		if (bStaticDrawPath)
+		{
+			GetScene().UpdateCachedRenderStates(this);
+		}
+	}
+
+	// GPU bytes held by the vertex streams, readable from the game thread
+	SIZE_T GetVertexStreamMemorySize() const { return VertexStreamMemorySize.load(std::memory_order_relaxed); }
+
+	// GPU bytes per vertex of the streams bound for drawing, across all LODs
+	float GetResidentBytesPerVertex() const { return ResidentBytesPerVertex.load(std::memory_order_relaxed); }
+
+	// Leaves a frame in the mailbox. Returns true when no render command is on its way to pick it up yet,
+	// in which case the caller enqueues one; otherwise the pending command uploads this frame instead.
+	bool PostUpdate_GameThread(const FDirectProxyFrameRef& Frame, TConstArrayView<FDirectProxyDirtyRange> DirtyRanges)
+	{
+		FScopeLock Lock(&MailboxCriticalSection);
+
+		const int32 PendingIndex = PendingUpdates.IndexOfByPredicate([&Frame](const FPendingUpdate& Update) { return Update.Frame->LODIndex == Frame->LODIndex; });
+		if (PendingIndex == INDEX_NONE)
+		{
+			FPendingUpdate& Update = PendingUpdates.AddDefaulted_GetRef();
+			Update.Frame = Frame;
+			Update.DirtyRanges = DirtyRanges;
+			Update.TopologyGeneration = MailboxTopologyGeneration;
+		}
+		else
+		{
+			// Latest wins: partial frames carry the latest contents everywhere, so the newest frame covers the
+			// pending one as long as the ranges are merged. A full frame makes the pending ranges irrelevant.
+			FPendingUpdate Update = MoveTemp(PendingUpdates[PendingIndex]);
+			PendingUpdates.RemoveAt(PendingIndex);
+			if (DirtyRanges.Num() == 0)
+			{
+				INC_DWORD_STAT(STAT_DirectProxyMesh_UpdatesDropped);
+				Update.DirtyRanges.Reset();
+			}
+			else
+			{
+				INC_DWORD_STAT(STAT_DirectProxyMesh_UpdatesCoalesced);
+				if (Update.DirtyRanges.Num() > 0)
+				{
+					Update.DirtyRanges.Append(DirtyRanges.GetData(), DirtyRanges.Num());
+				}
+			}
+			Update.Frame = Frame;
+			Update.TopologyGeneration = MailboxTopologyGeneration;
+
+			// Most recent last, so the proxy ends up drawing the LOD that was submitted last
+			PendingUpdates.Add(MoveTemp(Update));
+		}
+
+		const bool bNeedsCommand = !bUpdateCommandQueued;
+		bUpdateCommandQueued = true;
+		return bNeedsCommand;
+	}
+
+	// Uploads whatever is in the mailbox; frames that were replaced while waiting are never uploaded.
+	// Frames built for a topology the render thread hasn't switched to yet stay in the mailbox: a command queued
+	// before the topology update must not upload them into the old streams. The frame that posted them enqueued
+	// its own command behind the topology update, which picks them up.
+	void ProcessPendingUpdates_RenderThread(FRHICommandListImmediate& RHICmdList)
+	{
+		TArray<FPendingUpdate, TInlineAllocator<1>> Updates;
+		{
+			FScopeLock Lock(&MailboxCriticalSection);
+			for (int32 Index = 0; Index < PendingUpdates.Num();)
+			{
+				if (PendingUpdates[Index].TopologyGeneration == TopologyGeneration)
+				{
+					Updates.Add(MoveTemp(PendingUpdates[Index]));
+					PendingUpdates.RemoveAt(Index);
+				}
+				else
+				{
+					Index++;
+				}
+			}
+			if (PendingUpdates.Num() == 0)
+			{
+				bUpdateCommandQueued = false;
+			}
+		}
+
+		for (const FPendingUpdate& Update : Updates)
+		{
+			UpdateDynamicData_RenderThread(RHICmdList, *Update.Frame, Update.DirtyRanges);
+		}
+	}
+
+	void UpdateDynamicData_RenderThread(FRHICommandListImmediate& RHICmdList, const FDirectProxyFrame& Frame, TConstArrayView<FDirectProxyDirtyRange> DirtyRanges)
+	{
+		LLM_SCOPE_BYTAG(DirectProxyMesh);
+
+		// Cached draw commands point at a single slot's vertex factory, so animating meshes are collected per frame
+		if (bStaticDrawPath)
+		{
+			bStaticDrawPath = false;
+			INC_DWORD_STAT(STAT_DirectProxyMesh_StaticSwitches);
+		}
+
+		FLODRenderData& LOD = LODs[Frame.LODIndex];
+
+		// Height field frames only carry the expand inputs; the slot below is then written by the GPU.
+		// Inputs that were never written need the whole frame, since any slot may be rebuilt from them.
+		if (bHeightField)
+		{
+			UploadHeightInputs(RHICmdList, LOD, Frame, LOD.bInputsValid ? DirtyRanges : TConstArrayView<FDirectProxyDirtyRange>());
+			LOD.bInputsValid = true;
+		}
+
+		// Write into the next slot in the ring instead of the one the GPU may still be reading from
+		// for a frame in flight. The slot is then bound by drawing with its vertex factory.
+		const int32 NextSlot = (LOD.CurrentSlot + 1) % LOD.VertexSlots.Num();
+
+		if (DirtyRanges.Num() == 0)
+		{
+			// Full update: every other slot is now stale everywhere
+			for (int32 SlotIndex = 0; SlotIndex < LOD.VertexSlots.Num(); SlotIndex++)
+			{
+				LOD.VertexSlots[SlotIndex].PendingRanges.Reset();
+				LOD.VertexSlots[SlotIndex].bFullUploadPending = SlotIndex != NextSlot;
+			}
+			WriteSlot(RHICmdList, LOD, LOD.VertexSlots[NextSlot], Frame, {});
+		}
+		else
+		{
+			// Every slot falls behind by these ranges. The slot written now catches up on everything it
+			// missed since it was last written, which the frame holds because partial frames carry the latest contents.
+			for (FDirectProxyVertexSlot& Slot : LOD.VertexSlots)
+			{
+				if (!Slot.bFullUploadPending)
+				{
+					Slot.PendingRanges.Append(DirtyRanges.GetData(), DirtyRanges.Num());
+				}
+			}
+
+			FDirectProxyVertexSlot& Slot = LOD.VertexSlots[NextSlot];
+			if (Slot.bFullUploadPending)
+			{
+				WriteSlot(RHICmdList, LOD, Slot, Frame, {});
+			}
+			else
+			{
+				MergeDirtyRanges(Slot.PendingRanges, LOD.NumVertices);
+				WriteSlot(RHICmdList, LOD, Slot, Frame, Slot.PendingRanges);
+			}
+			Slot.PendingRanges.Reset();
+			Slot.bFullUploadPending = false;
+		}
+
+		LOD.CurrentSlot = NextSlot;
+		LOD.UpdateSerial = ++LatestSerial;
+		LatestLOD = Frame.LODIndex;
+	}
+
+	void SetSectionVisibility_RenderThread(int32 SectionIndex, bool bVisible)
+	{
+		if (Sections.IsValidIndex(SectionIndex) && Sections[SectionIndex].bVisible != bVisible)
+		{
+			Sections[SectionIndex].bVisible = bVisible;
+
+			// Hidden sections are left out of the cached draw commands
+			if (bStaticDrawPath)
+			{
+				GetScene().UpdateCachedRenderStates(this);
+			}
+		}
+	}
+
+	// Called once the component has seen no updates for a while: draw from cached mesh draw commands again
+	void EnterStaticDrawPath_RenderThread()
+	{
+		if (!bStaticDrawPath)
+		{
+			bStaticDrawPath = true;
+			INC_DWORD_STAT(STAT_DirectProxyMesh_StaticSwitches);
+
+			// The cached commands were built for whichever slot was current back then; rebuild them for this one
+			GetScene().UpdateCachedRenderStates(this);
+		}
+	}
+
+	// Only the most recently written LOD is cached. A view that needs another one reports it, the producer
+	// submits that LOD and the proxy is back on the dynamic path until it goes idle again.
+	virtual void DrawStaticElements(FStaticPrimitiveDrawInterface* PDI) override
+	{
+		const FLODRenderData& LOD = LODs[LatestLOD];
+		if (LOD.NumVertices == 0 || LOD.Topology->IndexBuffer.NumIndices == 0 || LOD.UpdateSerial == 0)
+		{
+			return;
+		}
+
+		PDI->ReserveMemoryForMeshes(LOD.Topology->IndexChunks.Num());
+		for (const FDirectProxyIndexChunk& Chunk : LOD.Topology->IndexChunks)
+		{
+			if (!Sections[Chunk.SectionIndex].bVisible)
+			{
+				continue;
+			}
+			FMeshBatch Mesh;
+			BuildMeshBatch(Mesh, LatestLOD, Chunk);
+			PDI->DrawMesh(Mesh, FLT_MAX);
+		}
+	}
+
+	virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily, uint32 VisibilityMap, FMeshElementCollector& Collector) const override
+	{
+		for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+		{
+			if (VisibilityMap & (1 << ViewIndex))
+			{
+				const int32 LODIndex = GetLODToDraw(*Views[ViewIndex]);
+				const FLODRenderData& LOD = LODs[LODIndex];
+				if (LOD.NumVertices == 0 || LOD.Topology->IndexBuffer.NumIndices == 0 || LOD.UpdateSerial == 0)
+				{
+					continue;
+				}
+
+				for (const FDirectProxyIndexChunk& Chunk : LOD.Topology->IndexChunks)
+				{
+					if (!Sections[Chunk.SectionIndex].bVisible)
+					{
+						continue;
+					}
+					FMeshBatch& Mesh = Collector.AllocateMesh();
+					BuildMeshBatch(Mesh, LODIndex, Chunk);
+					Collector.AddMesh(ViewIndex, Mesh);
+				}
+			}
+		}
+	}
+
+	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+	{
+		// Runs for every view that didn't cull the mesh, on either draw path, so it's where LOD demand is reported
+		if (LODs.Num() > 1 && View->Family)
+		{
+			LODFeedback->ReportView(View->Family->FrameNumber, ComputeDesiredLOD(*View));
+		}
+
+		FPrimitiveViewRelevance Result;
+		Result.bDrawRelevance = IsShown(View);
+		Result.bShadowRelevance = IsShadowCast(View);
+		Result.bStaticRelevance = bStaticDrawPath;
+		Result.bDynamicRelevance = !bStaticDrawPath;
+		Result.bRenderInMainPass = ShouldRenderInMainPass();
+		Result.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
+		Result.bRenderCustomDepth = ShouldRenderCustomDepth();
+		MaterialRelevance.SetPrimitiveViewRelevance(Result);
+		return Result;
+	}
+
+	virtual uint32 GetMemoryFootprint() const override { return sizeof(*this) + GetAllocatedSize(); }
+
+	// CPU side only; the GPU streams are tracked by STAT_DirectProxyMesh_VertexStreamMemory and the topologies
+	uint32 GetAllocatedSize() const
+	{
+		SIZE_T Size = FPrimitiveSceneProxy::GetAllocatedSize() + LODs.GetAllocatedSize() + Sections.GetAllocatedSize();
+		for (const FLODRenderData& LOD : LODs)
+		{
+			Size += sizeof(FLODRenderData) + LOD.VertexSlots.GetAllocatedSize();
+			for (const FDirectProxyVertexSlot& Slot : LOD.VertexSlots)
+			{
+				Size += sizeof(FDirectProxyVertexSlot) + Slot.PendingRanges.GetAllocatedSize();
+			}
+		}
+		return static_cast<uint32>(Size);
+	}
+	SIZE_T GetTypeHash() const override { static size_t UniquePointer; return reinterpret_cast<size_t>(&UniquePointer); }
+	virtual bool CanBeOccluded() const override { return !MaterialRelevance.bDisableDepthTest; }
+
+private:
+	// Per-frame vertex streams and the vertex factory that reads from them
+	struct FDirectProxyVertexSlot
+	{
+		explicit FDirectProxyVertexSlot(ERHIFeatureLevel::Type InFeatureLevel)
+			: VertexFactory(InFeatureLevel, "FDirectProxyMeshVertexFactory")
+		{
+		}
+
+		FDirectProxyPositionBuffer PositionBuffer;
+		FDirectProxyTangentBuffer TangentBuffer;
+		FLocalVertexFactory VertexFactory;
+
+		// Vertices changed since this slot was last written
+		TArray<FDirectProxyDirtyRange> PendingRanges;
+		bool bFullUploadPending = true;
+	};
+
+	// Everything drawn for one LOD: its shared topology and its own rotating vertex streams
+	struct FLODRenderData
+	{
+		explicit FLODRenderData(const FDirectProxyTopologyRef& InTopology)
+			: Topology(InTopology)
+		{
+		}
+
+		// Shared index, UV, color and grid X/Y buffers
+		FDirectProxyTopologyRef Topology;
+
+		// Rotating position/tangent streams; CurrentSlot holds the most recently written data
+		TIndirectArray<FDirectProxyVertexSlot> VertexSlots;
+		int32 CurrentSlot = 0;
+		int32 NumVertices = 0;
+		float ScreenSize = 0.0f;
+
+		// Per-frame expand inputs, only created in height field mode
+		FDirectProxyTypedBuffer HeightBuffer{TEXT("DirectProxyHeightBuffer"), sizeof(float), PF_R32_FLOAT};
+		FDirectProxyTypedBuffer PackedNormalBuffer{TEXT("DirectProxyPackedNormalBuffer"), sizeof(FPackedNormal), PF_R8G8B8A8_SNORM};
+		bool bInputsValid = false;
+
+		// LatestSerial at the time this LOD was last written; 0 if it never was
+		uint32 UpdateSerial = 0;
+	};
+
+	// Coarsest LOD whose screen size threshold the view's screen size is below
+	int32 ComputeDesiredLOD(const FSceneView& View) const
+	{
+		const FBoxSphereBounds& Bounds = GetBounds();
+		const float ScreenSize = ComputeBoundsScreenSize(Bounds.Origin, static_cast<float>(Bounds.SphereRadius), View);
+		int32 LODIndex = 0;
+		for (int32 Index = 1; Index < LODs.Num(); Index++)
+		{
+			if (ScreenSize < LODs[Index].ScreenSize)
+			{
+				LODIndex = Index;
+			}
+		}
+		return LODIndex;
+	}
+
+	// The LOD the view asks for if it holds the latest data, otherwise the most recently written LOD,
+	// so a view never draws vertices older than the last submitted frame
+	int32 GetLODToDraw(const FSceneView& View) const
+	{
+		if (LODs.Num() == 1)
+		{
+			return 0;
+		}
+		const int32 DesiredLOD = ComputeDesiredLOD(View);
+		return LODs[DesiredLOD].UpdateSerial == LatestSerial ? DesiredLOD : LatestLOD;
+	}
+
+	// Binds the slot's streams and the LOD's shared UV and color buffers; re-initializes the factory if it already was
+	void SetVertexFactoryData(FRHICommandListBase& RHICmdList, const FLODRenderData& LOD, FDirectProxyVertexSlot& Slot) const
+	{
+		// Quantized positions are fetched as UShort4N ([0, 1]); the render matrix scales them back into the bounds
+		FLocalVertexFactory::FDataType Data;
+		Data.PositionComponent = FVertexStreamComponent(&Slot.PositionBuffer, 0, Slot.PositionBuffer.GetStride(),
+			Slot.PositionBuffer.bQuantized ? VET_UShort4N : VET_Float3);
+		Data.PositionComponentSRV = Slot.PositionBuffer.SRV;
+		Data.TangentBasisComponents[0] = FVertexStreamComponent(&Slot.TangentBuffer, 0, 2 * sizeof(FPackedNormal), VET_PackedNormal);
+		Data.TangentBasisComponents[1] = FVertexStreamComponent(&Slot.TangentBuffer, sizeof(FPackedNormal), 2 * sizeof(FPackedNormal), VET_PackedNormal);
+		Data.TangentsSRV = Slot.TangentBuffer.SRV;
+		Data.TextureCoordinates.Add(FVertexStreamComponent(&LOD.Topology->TexCoordBuffer, 0, sizeof(FVector2f), VET_Float2));
+		Data.TextureCoordinatesSRV = LOD.Topology->TexCoordBuffer.SRV;
+		Data.NumTexCoords = 1;
+
+		if (EnumHasAnyFlags(VertexStreams, EDirectProxyVertexStreams::VertexColor) && LOD.Topology->Colors.Num() > 0)
+		{
+			Data.ColorComponent = FVertexStreamComponent(&LOD.Topology->ColorBuffer, 0, sizeof(FColor), VET_Color);
+			Data.ColorComponentsSRV = LOD.Topology->ColorBuffer.SRV;
+		}
+		else
+		{
+			// Stride 0: every vertex reads the same white color
+			Data.ColorComponent = FVertexStreamComponent(&GNullColorVertexBuffer, 0, 0, VET_Color, EVertexStreamUsage::ManualFetch);
+			Data.ColorComponentsSRV = GNullColorVertexBuffer.VertexBufferSRV;
+			Data.ColorIndexMask = 0;
+		}
+
+		// Left out of the vertex declaration unless asked for; the UVs double as lightmap coordinates
+		if (EnumHasAnyFlags(VertexStreams, EDirectProxyVertexStreams::LightMapUV))
+		{
+			Data.LightMapCoordinateComponent = FVertexStreamComponent(&LOD.Topology->TexCoordBuffer, 0, sizeof(FVector2f), VET_Float2);
+			Data.LightMapCoordinateIndex = 0;
+		}
+
+		Slot.VertexFactory.SetData(RHICmdList, Data);
+	}
+
+	// Recomputes the GPU size of the vertex streams from their current capacities
+	void UpdateVertexStreamMemoryStat()
+	{
+		SIZE_T Size = 0;
+		for (const FLODRenderData& LOD : LODs)
+		{
+			Size += LOD.HeightBuffer.GetBufferSize() + LOD.PackedNormalBuffer.GetBufferSize();
+			for (const FDirectProxyVertexSlot& Slot : LOD.VertexSlots)
+			{
+				Size += Slot.PositionBuffer.GetBufferSize() + Slot.TangentBuffer.GetBufferSize();
+			}
+		}
+		DEC_MEMORY_STAT_BY(STAT_DirectProxyMesh_VertexStreamMemory, VertexStreamMemorySize.load());
+		INC_MEMORY_STAT_BY(STAT_DirectProxyMesh_VertexStreamMemory, Size);
+		VertexStreamMemorySize = Size;
+
+		// Shared topology buffers count in full here; null and omitted streams cost nothing
+		SIZE_T TotalSize = Size;
+		int32 TotalVertices = 0;
+		for (const FLODRenderData& LOD : LODs)
+		{
+			TotalSize += LOD.Topology->GetVertexBufferMemorySize();
+			TotalVertices += LOD.NumVertices;
+		}
+		ResidentBytesPerVertex = TotalVertices > 0 ? static_cast<float>(static_cast<double>(TotalSize) / TotalVertices) : 0.0f;
+	}
+
+	static void UploadToSlot(FRHICommandListBase& RHICmdList, FDirectProxyVertexSlot& Slot, const FDirectProxyFrame& Frame)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DirectProxyMesh_Upload);
+		Slot.PositionBuffer.UpdateData(RHICmdList, Frame);
+		Slot.TangentBuffer.UpdateData(RHICmdList, Frame.TangentBasis);
+
+		INC_DWORD_STAT(STAT_DirectProxyMesh_Uploads);
+		INC_DWORD_STAT_BY(STAT_DirectProxyMesh_BytesUploaded, Frame.GetNumVertices() * (Slot.PositionBuffer.GetStride() + 2 * sizeof(FPackedNormal)));
+	}
+
+	static void UploadRangesToSlot(FRHICommandListBase& RHICmdList, FDirectProxyVertexSlot& Slot, const FDirectProxyFrame& Frame, TConstArrayView<FDirectProxyDirtyRange> Ranges)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DirectProxyMesh_Upload);
+		int32 NumUploaded = 0;
+		for (const FDirectProxyDirtyRange& Range : Ranges)
+		{
+			Slot.PositionBuffer.UpdateRange(RHICmdList, Frame, Range.FirstVertex, Range.NumVertices);
+			Slot.TangentBuffer.UpdateRange(RHICmdList, Frame.TangentBasis, Range.FirstVertex, Range.NumVertices);
+			NumUploaded += Range.NumVertices;
+		}
+
+		INC_DWORD_STAT(STAT_DirectProxyMesh_PartialUploads);
+		INC_DWORD_STAT_BY(STAT_DirectProxyMesh_BytesUploaded, NumUploaded * (Slot.PositionBuffer.GetStride() + 2 * sizeof(FPackedNormal)));
+	}
+
+	// Same batch for both draw paths, reading from the LOD's current slot
+	void BuildMeshBatch(FMeshBatch& Mesh, int32 LODIndex, const FDirectProxyIndexChunk& Chunk) const
+	{
+		const FLODRenderData& LOD = LODs[LODIndex];
+		Mesh.VertexFactory = &LOD.VertexSlots[LOD.CurrentSlot].VertexFactory;
+		Mesh.Type = PT_TriangleList;
+
+		FMeshBatchElement& BatchElement = Mesh.Elements[0];
+		BatchElement.IndexBuffer = &LOD.Topology->IndexBuffer;
+		BatchElement.FirstIndex = Chunk.FirstIndex;
+		BatchElement.NumPrimitives = Chunk.NumIndices / 3;
+		BatchElement.BaseVertexIndex = Chunk.BaseVertexIndex;
+		BatchElement.MinVertexIndex = Chunk.MinVertexIndex;
+		BatchElement.MaxVertexIndex = Chunk.MaxVertexIndex;
+
+		Mesh.MaterialRenderProxy = Sections[Chunk.SectionIndex].Material->GetRenderProxy();
+		Mesh.SegmentIndex = static_cast<uint8>(FMath::Min(Chunk.SectionIndex, static_cast<int32>(MAX_uint8)));
+		Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
+		Mesh.bDisableBackfaceCulling = false;
+		Mesh.CastShadow = true;
+		Mesh.bUseAsOccluder = false;
+		Mesh.LODIndex = static_cast<int8>(LODIndex);
+	}
+
+	// Writes a whole slot (no ranges) or only the given ranges, from the frame or, for height fields, on the GPU
+	void WriteSlot(FRHICommandListImmediate& RHICmdList, const FLODRenderData& LOD, FDirectProxyVertexSlot& Slot, const FDirectProxyFrame& Frame, TConstArrayView<FDirectProxyDirtyRange> Ranges) const
+	{
+		if (bHeightField)
+		{
+			ExpandToSlot(RHICmdList, LOD, Slot, Ranges);
+		}
+		else if (Ranges.Num() == 0)
+		{
+			UploadToSlot(RHICmdList, Slot, Frame);
+		}
+		else
+		{
+			UploadRangesToSlot(RHICmdList, Slot, Frame, Ranges);
+		}
+	}
+
+	// Uploads the per-frame expand inputs: 4 bytes of height and 4 bytes of packed normal per vertex
+	static void UploadHeightInputs(FRHICommandListBase& RHICmdList, FLODRenderData& LOD, const FDirectProxyFrame& Frame, TConstArrayView<FDirectProxyDirtyRange> DirtyRanges)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DirectProxyMesh_Upload);
+		check(Frame.Layout == EDirectProxyFrameLayout::Heights);
+
+		TArray<FDirectProxyDirtyRange, TInlineAllocator<16>> Ranges;
+		if (DirtyRanges.Num() == 0)
+		{
+			Ranges.Emplace(0, LOD.NumVertices);
+			INC_DWORD_STAT(STAT_DirectProxyMesh_Uploads);
+		}
+		else
+		{
+			TArray<FDirectProxyDirtyRange> Merged(DirtyRanges);
+			MergeDirtyRanges(Merged, LOD.NumVertices);
+			Ranges.Append(Merged);
+			INC_DWORD_STAT(STAT_DirectProxyMesh_PartialUploads);
+		}
+
+		int32 NumUploaded = 0;
+		for (const FDirectProxyDirtyRange& Range : Ranges)
+		{
+			LOD.HeightBuffer.UpdateRange(RHICmdList, Frame.Heights.GetData(), Range.FirstVertex, Range.NumVertices);
+			LOD.PackedNormalBuffer.UpdateRange(RHICmdList, Frame.PackedNormals.GetData(), Range.FirstVertex, Range.NumVertices);
+			NumUploaded += Range.NumVertices;
+		}
+		INC_DWORD_STAT_BY(STAT_DirectProxyMesh_BytesUploaded, NumUploaded * (sizeof(float) + sizeof(FPackedNormal)));
+	}
+
+	// Rebuilds the slot's position and tangent streams from the expand inputs, over the given ranges or everything
+	void ExpandToSlot(FRHICommandListImmediate& RHICmdList, const FLODRenderData& LOD, FDirectProxyVertexSlot& Slot, TConstArrayView<FDirectProxyDirtyRange> Ranges) const
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DirectProxyMesh_Upload);
+		const FDirectProxyDirtyRange FullRange(0, LOD.NumVertices);
+		const TConstArrayView<FDirectProxyDirtyRange> ExpandRanges = Ranges.Num() > 0 ? Ranges : MakeArrayView(&FullRange, 1);
+
+		RHICmdList.Transition({
+			FRHITransitionInfo(Slot.PositionBuffer.UAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute),
+			FRHITransitionInfo(Slot.TangentBuffer.UAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute)
+		});
+
+		for (const FDirectProxyDirtyRange& Range : ExpandRanges)
+		{
+			FDirectProxyHeightFieldExpandParams Params;
+			Params.GridXY = LOD.Topology->GridXYBuffer.SRV;
+			Params.Heights = LOD.HeightBuffer.SRV;
+			Params.PackedNormals = LOD.PackedNormalBuffer.SRV;
+			Params.OutPositions = Slot.PositionBuffer.UAV;
+			Params.OutTangents = Slot.TangentBuffer.UAV;
+			Params.FirstVertex = Range.FirstVertex;
+			Params.NumVertices = Range.NumVertices;
+			DispatchDirectProxyHeightFieldExpand(RHICmdList, FeatureLevel, Params);
+		}
+
+		RHICmdList.Transition({
+			FRHITransitionInfo(Slot.PositionBuffer.UAV, ERHIAccess::UAVCompute, ERHIAccess::VertexOrIndexBuffer | ERHIAccess::SRVMask),
+			FRHITransitionInfo(Slot.TangentBuffer.UAV, ERHIAccess::UAVCompute, ERHIAccess::VertexOrIndexBuffer | ERHIAccess::SRVMask)
+		});
+	}
+
+	// LOD 0 is the full resolution mesh
+	TIndirectArray<FLODRenderData> LODs;
+
+	// Most recently written LOD and a counter bumped on every write, to tell which LODs hold the latest data
+	int32 LatestLOD = 0;
+	uint32 LatestSerial = 0;
+
+	struct FSectionDrawInfo
+	{
+		UMaterialInterface* Material = nullptr;
+		bool bVisible = true;
+	};
+	TArray<FSectionDrawInfo> Sections;
+
+	FMaterialRelevance MaterialRelevance;
+	TSharedRef<FDirectProxyLODFeedback, ESPMode::ThreadSafe> LODFeedback;
+
+	ERHIFeatureLevel::Type FeatureLevel;
+	bool bHeightField = false;
+
+	// Drawn through cached static draw commands while no updates arrive; new proxies start there
+	bool bStaticDrawPath = false;
+
+	EDirectProxyVertexStreams VertexStreams;
+
+	FDirectProxyFramePtr InitialFrame;
+	FDirectProxyFramePtr InitialExpandedFrame;
+
+	// GPU bytes of every LOD's vertex streams, counted in the memory stat once created
+	std::atomic<SIZE_T> VertexStreamMemorySize{0};
+	std::atomic<float> ResidentBytesPerVertex{0.0f};
+
+	// Latest-wins mailbox between SubmitFrame and the render thread, at most one frame per LOD
+	struct FPendingUpdate
+	{
+		FDirectProxyFramePtr Frame;
+		// Empty for a full update
+		TArray<FDirectProxyDirtyRange> DirtyRanges;
+		// MailboxTopologyGeneration when the frame was posted
+		uint32 TopologyGeneration = 0;
+	};
+	FCriticalSection MailboxCriticalSection;
+	TArray<FPendingUpdate, TInlineAllocator<1>> PendingUpdates;
+	bool bUpdateCommandQueued = false;
+
+	// Bumped on the game thread for every in place topology update, and picked up by the render thread when the
+	// update runs there. Only frames of the render thread's generation fit its vertex streams.
+	uint32 MailboxTopologyGeneration = 0;
+	uint32 TopologyGeneration = 0;
+};
+
+// ============================================================================
+// UDirectProxyMeshComponent Implementation
+// ============================================================================
+
+UDirectProxyMeshComponent::UDirectProxyMeshComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	LocalBounds = FBox(ForceInit);
+	FramePool = MakeShared<FDirectProxyFramePool, ESPMode::ThreadSafe>();
+	LODFeedback = MakeShared<FDirectProxyLODFeedback, ESPMode::ThreadSafe>();
+}
+
+void UDirectProxyMeshComponent::SetStaticTopology(TArray<uint32>&& InIndices, TArray<FVector2f>&& InTexCoords, int32 InNumVertices)
+{
+	SetStaticTopology(MoveTemp(InIndices), MoveTemp(InTexCoords), InNumVertices, TArray<FDirectProxyMeshSection>());
+}
+
+void UDirectProxyMeshComponent::SetStaticTopology(TArray<uint32>&& InIndices, TArray<FVector2f>&& InTexCoords, int32 InNumVertices, TArray<FDirectProxyMeshSection>&& InSections)
+{
+	TArray<FDirectProxyLODTopology> Chain;
+	FDirectProxyLODTopology& LOD = Chain.AddDefaulted_GetRef();
+	LOD.Indices = MoveTemp(InIndices);
+	LOD.TexCoords = MoveTemp(InTexCoords);
+	LOD.Sections = MoveTemp(InSections);
+	LOD.NumVertices = InNumVertices;
+	SetLODChain(MoveTemp(Chain));
+}
+
+void UDirectProxyMeshComponent::SetStaticGridTopology(TArray<uint32>&& InIndices, TArray<FVector2f>&& InTexCoords, TArray<FVector2f>&& InGridXY)
+{
+	TArray<FDirectProxyLODTopology> Chain;
+	FDirectProxyLODTopology& LOD = Chain.AddDefaulted_GetRef();
+	LOD.Indices = MoveTemp(InIndices);
+	LOD.TexCoords = MoveTemp(InTexCoords);
+	LOD.NumVertices = InGridXY.Num();
+	LOD.GridXY = MoveTemp(InGridXY);
+	SetLODChain(MoveTemp(Chain));
+}
+
+void UDirectProxyMeshComponent::SetLODChain(TArray<FDirectProxyLODTopology>&& InLODs)
+{
+	checkf(InLODs.Num() > 0, TEXT("A LOD chain needs at least one LOD"));
+
+	for (FDirectProxyLODTopology& LOD : InLODs)
+	{
+		// No sections means one section over every index, drawn with material slot 0
+		if (LOD.Sections.Num() == 0)
+		{
+			FDirectProxyMeshSection& Section = LOD.Sections.AddDefaulted_GetRef();
+			Section.NumIndices = LOD.Indices.Num();
+		}
+		for (const FDirectProxyMeshSection& Section : LOD.Sections)
+		{
+			checkf(Section.FirstIndex >= 0 && Section.NumIndices >= 0 && Section.FirstIndex + Section.NumIndices <= LOD.Indices.Num()
+				&& Section.FirstIndex % 3 == 0 && Section.NumIndices % 3 == 0 && Section.MaterialIndex >= 0,
+				TEXT("Section index ranges must be whole triangles inside the index array"));
+		}
+
+		// Sections and the stream layout belong to the component, so every LOD has to agree on them
+		checkf(LOD.Sections.Num() == InLODs[0].Sections.Num(), TEXT("Every LOD needs the same number of sections"));
+		checkf((LOD.GridXY.Num() > 0) == (InLODs[0].GridXY.Num() > 0), TEXT("Either every LOD is a height field or none is"));
+		checkf(LOD.Colors.Num() == 0 || LOD.Colors.Num() == LOD.NumVertices, TEXT("Vertex colors need one color per vertex"));
+	}
+
+	// With the same LOD count, stream layout and section materials, the current proxy swaps topologies in place
+	// instead of being recreated: it keeps its vertex factories and only reallocates streams that outgrow their capacity
+	bool bUpdateInPlace = SceneProxy != nullptr && LODs.Num() == InLODs.Num() && IsHeightFieldMode() == (InLODs[0].GridXY.Num() > 0)
+		&& Sections.Num() == InLODs[0].Sections.Num();
+	for (int32 SectionIndex = 0; bUpdateInPlace && SectionIndex < Sections.Num(); SectionIndex++)
+	{
+		// The proxy resolves section materials once, when it is created
+		bUpdateInPlace = Sections[SectionIndex].MaterialIndex == InLODs[0].Sections[SectionIndex].MaterialIndex
+			&& Sections[SectionIndex].bVisible == InLODs[0].Sections[SectionIndex].bVisible;
+	}
+
+	// Material slots and visibility come from LOD 0; the other LODs only supply index ranges
+	Sections = InLODs[0].Sections;
 
-		CachedPositions = InPositions;
-		CachedNormals = InNormals;
-		CachedTexCoords = InTexCoords;
-		CachedIndices = InIndices;
+	TArray<FLODState> NewLODs;
+	for (int32 LODIndex = 0; LODIndex < InLODs.Num(); LODIndex++)
+	{
+		FDirectProxyLODTopology& In = InLODs[LODIndex];
+		FLODState& LOD = NewLODs.AddDefaulted_GetRef();
+		LOD.ScreenSize = In.ScreenSize;
+
+		// Identical topologies (same grid resolution, say) share one CPU copy and one set of GPU buffers
+		LOD.Topology = FDirectProxyTopologyRegistry::Get().FindOrCreate(MoveTemp(In));
+		LOD.Topology->AddUser();
+
+		// A frame for the old vertex count, or one carrying positions for a height field (or the reverse),
+		// can't be drawn with the new topology
+		if (LODs.IsValidIndex(LODIndex))
+		{
+			const FDirectProxyFramePtr& OldFrame = LODs[LODIndex].LatestFrame;
+			if (OldFrame.IsValid() && OldFrame->GetNumVertices() == LOD.Topology->NumVertices
+				&& (OldFrame->Layout == EDirectProxyFrameLayout::Heights) == (LOD.Topology->GridXY.Num() > 0))
+			{
+				LOD.LatestFrame = OldFrame;
+			}
+		}
 	}
 
-	virtual ~FDirectProxyMeshSceneProxy()
+	ReleaseTopologies();
+	LODs = MoveTemp(NewLODs);
+
+	// A new proxy starts from the most recent frame that survived
+	if (!LODs.IsValidIndex(LatestLOD) || !LODs[LatestLOD].LatestFrame.IsValid())
 	{
-		PositionBuffer.ReleaseResource();
-		TangentBuffer.ReleaseResource();
-		TexCoordBuffer.ReleaseResource();
-		ColorBuffer.ReleaseResource();
-		IndexBuffer.ReleaseResource();
-		VertexFactory.ReleaseResource();
+		LatestLOD = FMath::Max(LODs.IndexOfByPredicate([](const FLODState& LOD) { return LOD.LatestFrame.IsValid(); }), 0);
 	}
 
-	virtual void CreateRenderThreadResources(FRHICommandListBase& RHICmdList) override
+	if (bUpdateInPlace)
 	{
-		PositionBuffer.InitResource(RHICmdList);
-		TangentBuffer.InitResource(RHICmdList);
-		TexCoordBuffer.InitResource(RHICmdList);
-		ColorBuffer.InitResource(RHICmdList);
-		IndexBuffer.InitResource(RHICmdList);
+		TArray<FDirectProxyTopologyRef, TInlineAllocator<4>> Topologies;
+		TArray<float, TInlineAllocator<4>> ScreenSizes;
+		for (const FLODState& LOD : LODs)
+		{
+			Topologies.Add(LOD.Topology.ToSharedRef());
+			ScreenSizes.Add(LOD.ScreenSize);
+		}
+
+		FDirectProxyMeshSceneProxy* Proxy = static_cast<FDirectProxyMeshSceneProxy*>(SceneProxy);
+		bool bDiscardedUpdates = false;
+		const uint32 TopologyGeneration = Proxy->DiscardPendingUpdates_GameThread(bDiscardedUpdates);
+		ENQUEUE_RENDER_COMMAND(UpdateDirectProxyMeshTopology)(
+			[Proxy, Topologies = MoveTemp(Topologies), ScreenSizes = MoveTemp(ScreenSizes), TopologyGeneration](FRHICommandListImmediate& RHICmdList)
+			{
+				Proxy->UpdateTopology_RenderThread(RHICmdList, Topologies, ScreenSizes, TopologyGeneration);
+			}
+		);
 
-		PositionBuffer.UpdateData(RHICmdList, CachedPositions);
-		TangentBuffer.UpdateData(RHICmdList, CachedNormals);
-		TexCoordBuffer.SetData(RHICmdList, CachedTexCoords);
-		IndexBuffer.SetData(RHICmdList, CachedIndices);
+		// Frames that were still waiting in the mailbox are gone; the latest one is resent if it fits the new topology
+		if (bDiscardedUpdates && LODs[LatestLOD].LatestFrame.IsValid())
+		{
+			PostFrameToProxy(LODs[LatestLOD].LatestFrame.ToSharedRef(), {});
+		}
+		return;
+	}
 
-		CachedPositions.Empty();
-		CachedNormals.Empty();
-		CachedTexCoords.Empty();
-		CachedIndices.Empty();
+	// Even with the same geometry, material slots or visibility may have changed
+	MarkRenderStateDirty();
+}
 
-		FLocalVertexFactory::FDataType Data;
-		Data.PositionComponent = FVertexStreamComponent(&PositionBuffer, 0, sizeof(FVector3f), VET_Float3);
-		Data.PositionComponentSRV = PositionBuffer.SRV;
-		Data.TangentBasisComponents[0] = FVertexStreamComponent(&TangentBuffer, 0, 2 * sizeof(FPackedNormal), VET_PackedNormal);
-		Data.TangentBasisComponents[1] = FVertexStreamComponent(&TangentBuffer, sizeof(FPackedNormal), 2 * sizeof(FPackedNormal), VET_PackedNormal);
-		Data.TangentsSRV = TangentBuffer.SRV;
-		Data.ColorComponent = FVertexStreamComponent(&ColorBuffer, 0, sizeof(FColor), VET_Color);
-		Data.ColorComponentsSRV = ColorBuffer.SRV;
-		Data.TextureCoordinates.Add(FVertexStreamComponent(&TexCoordBuffer, 0, sizeof(FVector2f), VET_Float2));
-		Data.TextureCoordinatesSRV = TexCoordBuffer.SRV;
-		Data.NumTexCoords = 1;
-		Data.LightMapCoordinateComponent = FVertexStreamComponent(&TexCoordBuffer, 0, sizeof(FVector2f), VET_Float2);
-		Data.LightMapCoordinateIndex = 0;
+int32 UDirectProxyMeshComponent::GetRequiredLOD() const
+{
+	return FMath::Clamp(LODFeedback->RequiredLOD.load(std::memory_order_relaxed), 0, FMath::Max(LODs.Num() - 1, 0));
+}
 
-		VertexFactory.SetData(RHICmdList, Data);
-		VertexFactory.InitResource(RHICmdList);
+int32 UDirectProxyMeshComponent::GetNumVertices(int32 LODIndex) const
+{
+	return LODs.IsValidIndex(LODIndex) ? LODs[LODIndex].Topology->NumVertices : 0;
+}
+
+int32 UDirectProxyMeshComponent::GetNumMaterialsForSections(TConstArrayView<FDirectProxyMeshSection> InSections)
+{
+	int32 NumMaterials = 1;
+	for (const FDirectProxyMeshSection& Section : InSections)
+	{
+		NumMaterials = FMath::Max(NumMaterials, Section.MaterialIndex + 1);
 	}
+	return NumMaterials;
+}
+
+int32 UDirectProxyMeshComponent::GetNumMaterials() const
+{
+	return GetNumMaterialsForSections(Sections);
+}
 
-	void UpdateDynamicData_RenderThread(FRHICommandListBase& RHICmdList, FDirectProxyDynamicData&& NewData)
+void UDirectProxyMeshComponent::SetSectionVisible(int32 SectionIndex, bool bNewVisibility)
+{
+	if (!Sections.IsValidIndex(SectionIndex) || Sections[SectionIndex].bVisible == bNewVisibility)
 	{
-		PositionBuffer.UpdateData(RHICmdList, NewData.Positions);
-		TangentBuffer.UpdateData(RHICmdList, NewData.Normals);
+		return;
 	}
+	Sections[SectionIndex].bVisible = bNewVisibility;
 
-	virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily, uint32 VisibilityMap, FMeshElementCollector& Collector) const override
+	// Visibility doesn't need a new proxy
+	if (SceneProxy)
+	{
+		FDirectProxyMeshSceneProxy* Proxy = static_cast<FDirectProxyMeshSceneProxy*>(SceneProxy);
+		ENQUEUE_RENDER_COMMAND(SetDirectProxyMeshSectionVisibility)(
+			[Proxy, SectionIndex, bNewVisibility](FRHICommandListImmediate& RHICmdList)
+			{
+				Proxy->SetSectionVisibility_RenderThread(SectionIndex, bNewVisibility);
+			}
+		);
+	}
+}
+
+bool UDirectProxyMeshComponent::IsSectionVisible(int32 SectionIndex) const
+{
+	return Sections.IsValidIndex(SectionIndex) && Sections[SectionIndex].bVisible;
+}
+
+FDirectProxyDirtyRange UDirectProxyMeshComponent::GetSectionVertexRange(int32 SectionIndex, int32 LODIndex) const
+{
+	if (!LODs.IsValidIndex(LODIndex) || !LODs[LODIndex].Topology->SectionVertexRanges.IsValidIndex(SectionIndex))
+	{
+		return FDirectProxyDirtyRange(0, 0);
+	}
+	return LODs[LODIndex].Topology->SectionVertexRanges[SectionIndex];
+}
+
+void UDirectProxyMeshComponent::SubmitSections(const FDirectProxyFrameRef& Frame, TConstArrayView<int32> SectionIndices)
+{
+	TArray<FDirectProxyDirtyRange, TInlineAllocator<8>> Ranges;
+	for (const int32 SectionIndex : SectionIndices)
+	{
+		Ranges.Add(GetSectionVertexRange(SectionIndex, Frame->LODIndex));
+	}
+	SubmitFrame(Frame, Ranges);
+}
+
+void UDirectProxyMeshComponent::ReleaseTopologies()
+{
+	for (FLODState& LOD : LODs)
+	{
+		LOD.Topology->RemoveUser();
+	}
+	LODs.Reset();
+}
+
+bool UDirectProxyMeshComponent::IsHeightFieldMode() const
+{
+	return LODs.Num() > 0 && LODs[0].Topology->GridXY.Num() > 0;
+}
+
+bool UDirectProxyMeshComponent::HasValidMeshData() const
+{
+	return LODs.Num() > 0 && LODs[0].Topology->NumVertices > 0 && LODs[0].Topology->Indices.Num() > 0;
+}
+
+void UDirectProxyMeshComponent::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(LODs.GetAllocatedSize() + Sections.GetAllocatedSize());
+	if (FramePool.IsValid())
+	{
+		CumulativeResourceSize.AddDedicatedSystemMemoryBytes(FramePool->GetIdleMemorySize());
+	}
+
+	for (const FLODState& LOD : LODs)
 	{
-		if (PositionBuffer.NumVertices == 0 || IndexBuffer.NumIndices == 0)
+		// A shared topology isn't exclusive to this component, so it only counts towards estimated totals
+		if (CumulativeResourceSize.GetResourceSizeMode() == EResourceSizeMode::EstimatedTotal || LOD.Topology->GetNumUsers() <= 1)
 		{
-			return;
+			CumulativeResourceSize.AddDedicatedSystemMemoryBytes(LOD.Topology->GetCPUMemorySize());
+			CumulativeResourceSize.AddDedicatedVideoMemoryBytes(LOD.Topology->GetGPUMemorySize());
 		}
 
-		for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+		if (LOD.LatestFrame.IsValid())
 		{
-			if (VisibilityMap & (1 << ViewIndex))
-			{
-				FMeshBatch& Mesh = Collector.AllocateMesh();
-				Mesh.VertexFactory = &VertexFactory;
-				Mesh.Type = PT_TriangleList;
+			CumulativeResourceSize.AddDedicatedSystemMemoryBytes(sizeof(FDirectProxyFrame) + LOD.LatestFrame->GetAllocatedSize());
+		}
+	}
+
+	// The proxy's vertex streams, at their allocated capacity
+	if (SceneProxy)
+	{
+		CumulativeResourceSize.AddDedicatedVideoMemoryBytes(static_cast<FDirectProxyMeshSceneProxy*>(SceneProxy)->GetVertexStreamMemorySize());
+	}
+}
+
+void UDirectProxyMeshComponent::SetVertexStreams(EDirectProxyVertexStreams InStreams)
+{
+	if (VertexStreams != InStreams)
+	{
+		VertexStreams = InStreams;
+		MarkRenderStateDirty();
+	}
+}
+
+float UDirectProxyMeshComponent::GetResidentBytesPerVertex() const
+{
+	return SceneProxy ? static_cast<FDirectProxyMeshSceneProxy*>(SceneProxy)->GetResidentBytesPerVertex() : 0.0f;
+}
 
-				FMeshBatchElement& BatchElement = Mesh.Elements[0];
-				BatchElement.IndexBuffer = &IndexBuffer;
-				BatchElement.FirstIndex = 0;
-				BatchElement.NumPrimitives = IndexBuffer.NumIndices / 3;
-				BatchElement.MinVertexIndex = 0;
-				BatchElement.MaxVertexIndex = PositionBuffer.NumVertices - 1;
+static FAutoConsoleCommand DirectProxyMeshListMemoryCommand(
+	TEXT("DirectProxyMesh.ListMemory"),
+	TEXT("Logs the GPU memory and resident bytes per vertex of every direct proxy mesh component with a scene proxy."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UDirectProxyMeshComponent> It; It; ++It)
+		{
+			UDirectProxyMeshComponent* Component = *It;
+			if (!Component->SceneProxy)
+			{
+				continue;
+			}
 
-				Mesh.MaterialRenderProxy = Material->GetRenderProxy();
-				Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
-				Mesh.bDisableBackfaceCulling = false;
-				Mesh.CastShadow = true;
-				Mesh.bUseAsOccluder = false;
+			FResourceSizeEx ResourceSize(EResourceSizeMode::Exclusive);
+			Component->GetResourceSizeEx(ResourceSize);
 
-				Collector.AddMesh(ViewIndex, Mesh);
+			int32 NumVertices = 0;
+			for (int32 LODIndex = 0; LODIndex < Component->GetNumLODs(); LODIndex++)
+			{
+				NumVertices += Component->GetNumVertices(LODIndex);
 			}
+			UE_LOG(LogDirectProxyMesh, Log, TEXT("%s: %d vertices in %d LODs, %.1f bytes per vertex resident, %.1f KB GPU, %.1f KB CPU (exclusive)"),
+				*Component->GetPathName(), NumVertices, Component->GetNumLODs(), Component->GetResidentBytesPerVertex(),
+				ResourceSize.GetDedicatedVideoMemoryBytes() / 1024.0, ResourceSize.GetDedicatedSystemMemoryBytes() / 1024.0);
 		}
+	}));
+
+void UDirectProxyMeshComponent::BeginDestroy()
+{
+	ReleaseTopologies();
+	Super::BeginDestroy();
+}
+
+EDirectProxyFrameLayout UDirectProxyMeshComponent::GetFrameLayout() const
+{
+	if (IsHeightFieldMode())
+	{
+		return EDirectProxyFrameLayout::Heights;
 	}
+	return IsPositionQuantized() ? EDirectProxyFrameLayout::QuantizedPositions : EDirectProxyFrameLayout::Positions;
+}
 
-	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+void UDirectProxyMeshComponent::SetFixedBounds(const FBox& InBounds)
+{
+	const bool bBoundsChanged = !LocalBounds.Equals(InBounds);
+	const bool bRequantize = PositionFormat == EDirectProxyPositionFormat::Quantized16 && !IsHeightFieldMode() && bBoundsChanged;
+	LocalBounds = InBounds;
+	AutoBounds = FBox(ForceInit);
+	UpdateBounds();
+
+	// Topology updates keep the proxy, so new bounds have to be pushed to it
+	if (bBoundsChanged && !bRequantize)
 	{
-		FPrimitiveViewRelevance Result;
-		Result.bDrawRelevance = IsShown(View);
-		Result.bShadowRelevance = IsShadowCast(View);
-		Result.bDynamicRelevance = true;
-		Result.bRenderInMainPass = ShouldRenderInMainPass();
-		Result.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
-		Result.bRenderCustomDepth = ShouldRenderCustomDepth();
-		MaterialRelevance.SetPrimitiveViewRelevance(Result);
-		return Result;
+		MarkRenderTransformDirty();
 	}
 
-	virtual uint32 GetMemoryFootprint() const override { return sizeof(*this); }
-	SIZE_T GetTypeHash() const override { static size_t UniquePointer; return reinterpret_cast<size_t>(&UniquePointer); }
-	virtual bool CanBeOccluded() const override { return !MaterialRelevance.bDisableDepthTest; }
+	// Quantized positions are relative to the bounds: re-encode the last frames and rebuild the proxy,
+	// whose render matrix carries the dequantization transform.
+	if (bRequantize)
+	{
+		ResubmitLatestFrames();
+		MarkRenderStateDirty();
+	}
+}
 
-private:
-	FDirectProxyPositionBuffer PositionBuffer;
-	FDirectProxyTangentBuffer TangentBuffer;
-	FDirectProxyTexCoordBuffer TexCoordBuffer;
-	FDirectProxyColorBuffer ColorBuffer;
-	FDirectProxyIndexBuffer IndexBuffer;
-	FLocalVertexFactory VertexFactory;
+void UDirectProxyMeshComponent::SetPositionFormat(EDirectProxyPositionFormat InFormat, float InTolerance)
+{
+	QuantizationTolerance = InTolerance;
+	bWarnedQuantizationError = false;
+	LastQuantizationError = 0.0f;
 
-	UMaterialInterface* Material;
-	FMaterialRelevance MaterialRelevance;
+	if (PositionFormat != InFormat)
+	{
+		PositionFormat = InFormat;
+		ResubmitLatestFrames();
+		MarkRenderStateDirty();
+	}
+}
 
-	TArray<FVector3f> CachedPositions;
-	TArray<FVector3f> CachedNormals;
-	TArray<FVector2f> CachedTexCoords;
-	TArray<uint32> CachedIndices;
-};
+void UDirectProxyMeshComponent::ResubmitLatestFrames()
+{
+	// The most recent LOD goes last so it stays the one a new proxy starts with
+	const int32 KeepLatestLOD = LatestLOD;
+	for (int32 LODIndex = 0; LODIndex < LODs.Num(); LODIndex++)
+	{
+		if (LODIndex != KeepLatestLOD && LODs[LODIndex].LatestFrame.IsValid())
+		{
+			SubmitFrame(AcquireFrame(true, LODIndex));
+		}
+	}
+	if (LODs.IsValidIndex(KeepLatestLOD) && LODs[KeepLatestLOD].LatestFrame.IsValid())
+	{
+		SubmitFrame(AcquireFrame(true, KeepLatestLOD));
+	}
+}
 
-// ============================================================================
-// UDirectProxyMeshComponent Implementation
-// ============================================================================
+float UDirectProxyMeshComponent::GetMaxQuantizationError() const
+{
+	if (!IsPositionQuantized())
+	{
+		return 0.0f;
+	}
+	// Rounding moves each axis by at most half a step
+	return static_cast<float>((LocalBounds.GetSize() / QuantizedPositionRange * 0.5).Size());
+}
 
-UDirectProxyMeshComponent::UDirectProxyMeshComponent()
+FMatrix UDirectProxyMeshComponent::GetDequantizationMatrix() const
 {
-	PrimaryComponentTick.bCanEverTick = false;
-	LocalBounds = FBox(ForceInit);
+	return FScaleMatrix(LocalBounds.GetSize().ComponentMax(FVector(UE_KINDA_SMALL_NUMBER))) * FTranslationMatrix(LocalBounds.Min);
 }
 
-void UDirectProxyMeshComponent::SetStaticTopology(TArray<uint32>&& InIndices, TArray<FVector2f>&& InTexCoords, int32 InNumVertices)
+FDirectProxyFrameRef UDirectProxyMeshComponent::AcquireFrame(bool bPreserveContents, int32 LODIndex)
 {
-	Indices = MoveTemp(InIndices);
-	TexCoords = MoveTemp(InTexCoords);
-	NumVertices = InNumVertices;
+	checkf(LODs.IsValidIndex(LODIndex), TEXT("No topology set for LOD %d"), LODIndex);
 
-	// Pre-size dynamic buffers to avoid per-frame allocations
-	Positions.SetNumUninitialized(NumVertices);
-	Normals.SetNumUninitialized(NumVertices);
+	const EDirectProxyFrameLayout Layout = GetFrameLayout();
+	const int32 NumVertices = LODs[LODIndex].Topology->NumVertices;
+	FDirectProxyFramePtr& LatestFrame = LODs[LODIndex].LatestFrame;
 
-	MarkRenderStateDirty();
+	FDirectProxyFramePtr Frame;
+	if (!bPreserveContents || !LatestFrame.IsValid())
+	{
+		Frame = FramePool->Acquire(NumVertices, Layout);
+		Frame->bPreservedContents = false;
+	}
+	// Nobody but us references the last frame once it has been uploaded, so it can be written in place
+	else if (LatestFrame.IsUnique() && LatestFrame->Layout == Layout)
+	{
+		Frame = LatestFrame;
+		Frame->bPreservedContents = true;
+	}
+	// Still in flight on the render thread: start from a copy of it
+	else
+	{
+		Frame = FramePool->Acquire(NumVertices, Layout);
+		CopyFrameContents(*LatestFrame, *Frame);
+		Frame->bPreservedContents = true;
+	}
+
+	Frame->LODIndex = LODIndex;
+	return Frame.ToSharedRef();
 }
 
-void UDirectProxyMeshComponent::SetFixedBounds(const FBox& InBounds)
+void UDirectProxyMeshComponent::SubmitFrame(const FDirectProxyFrameRef& Frame)
 {
-	LocalBounds = InBounds;
-	UpdateBounds();
+	SubmitFrame(Frame, {});
 }
 
-void UDirectProxyMeshComponent::UpdateDynamicData(const TArray<FVector3f>& InPositions, const TArray<FVector3f>& InNormals)
+void UDirectProxyMeshComponent::SubmitFrame(const FDirectProxyFrameRef& Frame, TConstArrayView<FDirectProxyDirtyRange> DirtyRanges)
 {
-	// Copy into persistent buffers (avoids per-frame allocation)
-	FMemory::Memcpy(Positions.GetData(), InPositions.GetData(), InPositions.Num() * sizeof(FVector3f));
-	FMemory::Memcpy(Normals.GetData(), InNormals.GetData(), InNormals.Num() * sizeof(FVector3f));
+	LLM_SCOPE_BYTAG(DirectProxyMesh);
+	checkf(LODs.IsValidIndex(Frame->LODIndex), TEXT("Frame was acquired for a LOD that no longer exists"));
+
+	const EDirectProxyFrameLayout Layout = GetFrameLayout();
+	const bool bHeights = Layout == EDirectProxyFrameLayout::Heights;
+	const int32 NumVertices = LODs[Frame->LODIndex].Topology->NumVertices;
+	checkf((Frame->Layout == EDirectProxyFrameLayout::Heights) == bHeights, TEXT("Frame was acquired for a different topology"));
+	check(Frame->GetNumVertices() == NumVertices && (bHeights ? Frame->Heights.Num() : Frame->Positions.Num()) == NumVertices);
+	checkf(DirtyRanges.Num() == 0 || Frame->bPreservedContents, TEXT("Partial submits need a frame from AcquireFrame(true)"));
+
+	// A frame acquired before the position format changed has no encoded positions to patch, so it is prepared in full
+	const bool bQuantize = IsPositionQuantized();
+	const bool bFullPrepare = DirtyRanges.Num() == 0 || Frame->Layout != Layout;
+	FDirectProxyFramePool::SizeFrame(*Frame, NumVertices, Layout);
+
+	// Pack tangents (and encode positions) here on worker threads; the render thread only copies the result.
+	// A partial frame already holds the packed data for everything outside its dirty ranges.
+	TOptional<FDirectProxyQuantization> Quantization;
+	if (bQuantize)
+	{
+		Quantization.Emplace(LocalBounds, QuantizationTolerance > 0.0f);
+	}
+
+	float QuantizationError = 0.0f;
+	if (bFullPrepare)
+	{
+		QuantizationError = PrepareFrameParallel(*Frame, 0, NumVertices, Quantization.GetPtrOrNull());
+	}
+	else
+	{
+		for (const FDirectProxyDirtyRange& Range : DirtyRanges)
+		{
+			const int32 First = FMath::Clamp(Range.FirstVertex, 0, NumVertices);
+			const int32 Last = FMath::Clamp(Range.FirstVertex + Range.NumVertices, 0, NumVertices);
+			QuantizationError = FMath::Max(QuantizationError, PrepareFrameParallel(*Frame, First, Last - First, Quantization.GetPtrOrNull()));
+		}
+	}
+
+	if (bQuantize && QuantizationTolerance > 0.0f)
+	{
+		LastQuantizationError = QuantizationError;
+		if (QuantizationError > QuantizationTolerance && !bWarnedQuantizationError)
+		{
+			UE_LOG(LogDirectProxyMesh, Warning, TEXT("%s: quantized positions are off by up to %.4f, above the tolerance of %.4f. Positions outside the fixed bounds are clamped."),
+				*GetPathName(), QuantizationError, QuantizationTolerance);
+			bWarnedQuantizationError = true;
+		}
+	}
+
+	// Without fixed bounds the bounds follow the submitted vertices. A partial frame only contributes its dirty
+	// ranges, so the bounds can grow with it but only shrink on a full frame.
+	if (!LocalBounds.IsValid)
+	{
+		const FBox2f& GridBounds = LODs[Frame->LODIndex].Topology->GridBounds;
+		if (bFullPrepare)
+		{
+			UpdateAutoBounds(ComputeFrameBounds(*Frame, 0, NumVertices, GridBounds), true);
+		}
+		else
+		{
+			FBox RangeBounds(ForceInit);
+			for (const FDirectProxyDirtyRange& Range : DirtyRanges)
+			{
+				const int32 First = FMath::Clamp(Range.FirstVertex, 0, NumVertices);
+				const int32 Last = FMath::Clamp(Range.FirstVertex + Range.NumVertices, 0, NumVertices);
+				RangeBounds += ComputeFrameBounds(*Frame, First, Last - First, GridBounds);
+			}
+			UpdateAutoBounds(RangeBounds, false);
+		}
+	}
+
+	LODs[Frame->LODIndex].LatestFrame = Frame;
+	LatestLOD = Frame->LODIndex;
 
 	if (SceneProxy)
 	{
-		FDirectProxyDynamicData NewData;
-		NewData.Positions = Positions;
-		NewData.Normals = Normals;
+		// The proxy drops to the dynamic path on this update; tick to notice when updates stop again
+		IdleFrames = 0;
+		if (CVarDirectProxyStaticDrawIdleFrames.GetValueOnGameThread() > 0 && !IsComponentTickEnabled())
+		{
+			SetComponentTickEnabled(true);
+		}
 
-		FDirectProxyMeshSceneProxy* Proxy = static_cast<FDirectProxyMeshSceneProxy*>(SceneProxy);
+		PostFrameToProxy(Frame, DirtyRanges);
+	}
+}
+
+void UDirectProxyMeshComponent::PostFrameToProxy(const FDirectProxyFrameRef& Frame, TConstArrayView<FDirectProxyDirtyRange> DirtyRanges)
+{
+	// The mailbox holds a reference until the upload is done, then the frame returns to the pool. Frames
+	// submitted before the render thread gets to the previous one replace it instead of queueing behind it.
+	FDirectProxyMeshSceneProxy* Proxy = static_cast<FDirectProxyMeshSceneProxy*>(SceneProxy);
+	if (Proxy->PostUpdate_GameThread(Frame, DirtyRanges))
+	{
 		ENQUEUE_RENDER_COMMAND(UpdateDirectProxyMeshData)(
-			[Proxy, DynData = MoveTemp(NewData)](FRHICommandListImmediate& RHICmdList) mutable
+			[Proxy](FRHICommandListImmediate& RHICmdList)
+			{
+				Proxy->ProcessPendingUpdates_RenderThread(RHICmdList);
+			}
+		);
+	}
+}
+
+void UDirectProxyMeshComponent::UpdateDynamicData(const TArray<FVector3f>& InPositions, const TArray<FVector3f>& InNormals)
+{
+	check(InPositions.Num() == GetNumVertices() && InNormals.Num() == GetNumVertices());
+	checkf(!IsHeightFieldMode(), TEXT("Height field topologies take heights through AcquireFrame/SubmitFrame"));
+
+	FDirectProxyFrameRef Frame = AcquireFrame();
+	FMemory::Memcpy(Frame->Positions.GetData(), InPositions.GetData(), InPositions.Num() * sizeof(FVector3f));
+	FMemory::Memcpy(Frame->Normals.GetData(), InNormals.GetData(), InNormals.Num() * sizeof(FVector3f));
+	SubmitFrame(Frame);
+}
+
+void UDirectProxyMeshComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	const int32 StaticDrawIdleFrames = CVarDirectProxyStaticDrawIdleFrames.GetValueOnGameThread();
+	if (StaticDrawIdleFrames <= 0 || ++IdleFrames < StaticDrawIdleFrames)
+	{
+		return;
+	}
+
+	if (SceneProxy)
+	{
+		FDirectProxyMeshSceneProxy* Proxy = static_cast<FDirectProxyMeshSceneProxy*>(SceneProxy);
+		ENQUEUE_RENDER_COMMAND(EnterDirectProxyMeshStaticDrawPath)(
+			[Proxy](FRHICommandListImmediate& RHICmdList)
 			{
-				Proxy->UpdateDynamicData_RenderThread(RHICmdList, MoveTemp(DynData));
+				Proxy->EnterStaticDrawPath_RenderThread();
 			}
 		);
 	}
+	SetComponentTickEnabled(false);
 }
 
 FPrimitiveSceneProxy* UDirectProxyMeshComponent::CreateSceneProxy()
 {
-	if (!HasValidMeshData() || Positions.Num() == 0)
+	if (!HasValidMeshData() || !LODs.IsValidIndex(LatestLOD) || !LODs[LatestLOD].LatestFrame.IsValid())
+	{
+		return nullptr;
+	}
+
+	// The proxy's render matrix follows IsPositionQuantized(), so the frame has to be encoded to match
+	const FDirectProxyFrameRef LatestFrame = LODs[LatestLOD].LatestFrame.ToSharedRef();
+	if (LatestFrame->Layout != GetFrameLayout())
+	{
+		return nullptr;
+	}
+
+	// Height fields are expanded by a compute shader
+	if (IsHeightFieldMode() && GetScene() && GetScene()->GetFeatureLevel() < ERHIFeatureLevel::SM5)
 	{
+		UE_LOG(LogDirectProxyMesh, Warning, TEXT("%s: height field mode needs SM5, the mesh is not drawn."), *GetPathName());
 		return nullptr;
 	}
 
-	UMaterialInterface* Mat = GetMaterial(0);
-	if (!Mat)
+	TArray<FDirectProxyTopologyRef, TInlineAllocator<4>> Topologies;
+	TArray<float, TInlineAllocator<4>> ScreenSizes;
+	for (const FLODState& LOD : LODs)
+	{
+		Topologies.Add(LOD.Topology.ToSharedRef());
+		ScreenSizes.Add(LOD.ScreenSize);
+	}
+	return new FDirectProxyMeshSceneProxy(this, Topologies, ScreenSizes, LatestFrame, LODFeedback.ToSharedRef());
+}
+
+void UDirectProxyMeshComponent::UpdateAutoBounds(const FBox& TightBounds, bool bAllowShrink)
+{
+	if (!TightBounds.IsValid)
+	{
+		return;
+	}
+
+	// The padded bounds are only replaced when the vertices leave them or shrink well inside them, so small
+	// motions don't cost a bounds update and render transform update every frame
+	const bool bEscaped = !AutoBounds.IsValid || !AutoBounds.IsInsideOrOn(TightBounds.Min) || !AutoBounds.IsInsideOrOn(TightBounds.Max);
+	const bool bShrunk = bAllowShrink && AutoBounds.IsValid
+		&& TightBounds.GetSize().Size() < AutoBounds.GetSize().Size() * AutoBoundsShrinkThreshold;
+	if (!bEscaped && !bShrunk)
 	{
-		Mat = UMaterial::GetDefaultMaterial(MD_Surface);
+		return;
 	}
-	return new FDirectProxyMeshSceneProxy(this, Indices, TexCoords, Positions, Normals, Mat);
+
+	const FBox NewBounds = bAllowShrink || !AutoBounds.IsValid ? TightBounds : TightBounds + AutoBounds;
+	AutoBounds = NewBounds.ExpandBy(NewBounds.GetSize() * AutoBoundsPadding + FVector(UE_KINDA_SMALL_NUMBER));
+	INC_DWORD_STAT(STAT_DirectProxyMesh_AutoBoundsUpdates);
+
+	UpdateBounds();
+	MarkRenderTransformDirty();
 }
 
 FBoxSphereBounds UDirectProxyMeshComponent::CalcBounds(const FTransform& LocalToWorld) const
@@ -428,5 +2621,30 @@ FBoxSphereBounds UDirectProxyMeshComponent::CalcBounds(const FTransform& LocalTo
 	{
 		return FBoxSphereBounds(LocalBounds.TransformBy(LocalToWorld));
 	}
+	if (AutoBounds.IsValid)
+	{
+		return FBoxSphereBounds(AutoBounds.TransformBy(LocalToWorld));
+	}
 	return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
 }
+
+FBoxSphereBounds UDirectProxyMeshComponent::CalcLocalBounds() const
+{
+	// Quantized vertices live in the unit cube; the render matrix maps that onto the fixed bounds
+	if (IsPositionQuantized())
+	{
+		return FBoxSphereBounds(FBox(FVector::ZeroVector, FVector::OneVector));
+	}
+	return Super::CalcLocalBounds();
+}
+
+FMatrix UDirectProxyMeshComponent::GetRenderMatrix() const
+{
+	// The scene proxy sees quantized [0, 1] positions, so decoding is folded into its local-to-world transform.
+	// Vertex normals are unaffected: the vertex factory strips the non-uniform scale from the tangent basis.
+	if (IsPositionQuantized())
+	{
+		return GetDequantizationMatrix() * Super::GetRenderMatrix();
+	}
+	return Super::GetRenderMatrix();
+}
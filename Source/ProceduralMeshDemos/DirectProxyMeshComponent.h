@@ -7,8 +7,144 @@
 
 #include "CoreMinimal.h"
 #include "Components/MeshComponent.h"
+#include "PackedNormal.h"
 #include "DirectProxyMeshComponent.generated.h"
 
+class FDirectProxyFramePool;
+class FDirectProxyTopology;
+struct FDirectProxyLODFeedback;
+
+UENUM(BlueprintType)
+enum class EDirectProxyPositionFormat : uint8
+{
+	Float32      UMETA(DisplayName = "Full Precision (12 bytes)"),
+	Quantized16  UMETA(DisplayName = "16-bit Quantized to Fixed Bounds (8 bytes)")
+};
+
+// Position encoded as 16-bit unsigned normalized values relative to the component's fixed bounds (W unused)
+struct FDirectProxyQuantizedPosition
+{
+	uint16 X;
+	uint16 Y;
+	uint16 Z;
+	uint16 W;
+};
+
+// Which per-vertex streams a frame carries; follows the component's topology and position format
+enum class EDirectProxyFrameLayout : uint8
+{
+	// Positions + Normals, uploaded as float positions and packed tangent bases
+	Positions,
+	// Positions + Normals, uploaded as 16-bit positions and packed tangent bases
+	QuantizedPositions,
+	// Heights + Normals for grid topologies; X/Y are static and the GPU expands the rest
+	Heights
+};
+
+// One frame of per-vertex data handed from the producer to the render thread.
+// Frames come from a pool owned by the component; contents of a freshly acquired frame are undefined.
+// Producers fill Positions (or Heights for grid topologies) and Normals.
+struct FDirectProxyFrame
+{
+	TArray<FVector3f> Positions;
+	TArray<FVector3f> Normals;
+
+	// Per-vertex height for grid topologies set with SetStaticGridTopology
+	TArray<float> Heights;
+
+	// Tangent and normal packed per vertex (2 entries each). Filled on worker threads by SubmitFrame,
+	// so the render thread only has to copy it into the tangent buffer.
+	TArray<FPackedNormal> TangentBasis;
+
+	// Encoded positions, filled by SubmitFrame when the component uses EDirectProxyPositionFormat::Quantized16
+	TArray<FDirectProxyQuantizedPosition> QuantizedPositions;
+
+	// One packed normal per vertex, filled by SubmitFrame for grid topologies
+	TArray<FPackedNormal> PackedNormals;
+
+	EDirectProxyFrameLayout Layout = EDirectProxyFrameLayout::Positions;
+
+	// LOD of the component's chain this frame holds data for
+	int32 LODIndex = 0;
+
+	int32 GetNumVertices() const { return Normals.Num(); }
+
+	// Heap memory held by the streams, including capacity kept for reuse
+	SIZE_T GetAllocatedSize() const
+	{
+		return Positions.GetAllocatedSize() + Normals.GetAllocatedSize() + Heights.GetAllocatedSize() + TangentBasis.GetAllocatedSize()
+			+ QuantizedPositions.GetAllocatedSize() + PackedNormals.GetAllocatedSize();
+	}
+
+	// True when the frame was acquired with the latest submitted contents, which partial submits require
+	bool bPreservedContents = false;
+};
+
+// A contiguous run of vertices that changed since the last submitted frame
+struct FDirectProxyDirtyRange
+{
+	int32 FirstVertex = 0;
+	int32 NumVertices = 0;
+
+	FDirectProxyDirtyRange() = default;
+	FDirectProxyDirtyRange(int32 InFirstVertex, int32 InNumVertices) : FirstVertex(InFirstVertex), NumVertices(InNumVertices) {}
+
+	// Appends one range per row of a dirty rectangle in a row-major grid with RowLength vertices per row.
+	// Rect uses X for the column and Y for the row; Max is exclusive.
+	static void AddGridRect(TArray<FDirectProxyDirtyRange>& OutRanges, int32 RowLength, const FIntRect& Rect);
+};
+
+// A range of the topology's indices drawn with one material slot. Index ranges are part of the (shareable)
+// topology; the material slot and visibility belong to the component.
+struct FDirectProxyMeshSection
+{
+	int32 FirstIndex = 0;
+	int32 NumIndices = 0;
+	int32 MaterialIndex = 0;
+	bool bVisible = true;
+};
+
+// Optional vertex streams. Streams that are off bind the engine's shared null buffers or are left out of the
+// vertex declaration, so they cost no memory per vertex.
+enum class EDirectProxyVertexStreams : uint8
+{
+	None = 0,
+	// Bind the topology's vertex colors when it has any; otherwise every vertex reads white
+	VertexColor = 1 << 0,
+	// Bind the UVs as lightmap coordinates too
+	LightMapUV = 1 << 1,
+};
+ENUM_CLASS_FLAGS(EDirectProxyVertexStreams);
+
+// One level of a LOD chain passed to SetLODChain. LOD 0 is the full resolution mesh.
+struct FDirectProxyLODTopology
+{
+	TArray<uint32> Indices;
+	TArray<FVector2f> TexCoords;
+
+	// Optional static vertex colors, one per vertex
+	TArray<FColor> Colors;
+
+	// Static X/Y for height field LODs (see SetStaticGridTopology); either every LOD has them or none does
+	TArray<FVector2f> GridXY;
+
+	// Optional section index ranges; every LOD needs the same number of sections
+	TArray<FDirectProxyMeshSection> Sections;
+
+	int32 NumVertices = 0;
+
+	// This LOD is drawn once the mesh's screen size drops below this value (ignored for LOD 0)
+	float ScreenSize = 0.0f;
+};
+
+// Frames are shared between the game thread and the render thread, so the reference count is thread safe.
+// When the last reference is dropped (after the render thread has uploaded the frame) it goes back to the pool.
+using FDirectProxyFrameRef = TSharedRef<FDirectProxyFrame, ESPMode::ThreadSafe>;
+using FDirectProxyFramePtr = TSharedPtr<FDirectProxyFrame, ESPMode::ThreadSafe>;
+
+using FDirectProxyTopologyRef = TSharedRef<FDirectProxyTopology, ESPMode::ThreadSafe>;
+using FDirectProxyTopologyPtr = TSharedPtr<FDirectProxyTopology, ESPMode::ThreadSafe>;
+
 UCLASS(ClassGroup = (Rendering), meta = (BlueprintSpawnableComponent))
 class PROCEDURALMESHDEMOS_API UDirectProxyMeshComponent : public UMeshComponent
 {
@@ -17,33 +153,163 @@ class PROCEDURALMESHDEMOS_API UDirectProxyMeshComponent : public UMeshComponent
 public:
 	UDirectProxyMeshComponent();
 
-	// Called once when topology changes. Triggers proxy recreation.
+	// Called when the topology changes. An existing proxy with the same stream layout and section materials is
+	// updated in place (its buffers grow when needed); otherwise the proxy is recreated.
 	void SetStaticTopology(TArray<uint32>&& InIndices, TArray<FVector2f>&& InTexCoords, int32 InNumVertices);
 
-	// Called per frame to update positions and normals without recreating the proxy.
-	// Data is copied internally; callers may reuse their buffers.
+	// Multi-section variant: each section draws its index range with its own material slot
+	void SetStaticTopology(TArray<uint32>&& InIndices, TArray<FVector2f>&& InTexCoords, int32 InNumVertices, TArray<FDirectProxyMeshSection>&& InSections);
+
+	// Grid variant: X/Y never change, so they are uploaded once together with the UVs. Frames then only carry
+	// Heights and Normals (8 bytes per vertex on the wire) and a compute pass rebuilds the vertex streams on the GPU.
+	void SetStaticGridTopology(TArray<uint32>&& InIndices, TArray<FVector2f>&& InTexCoords, TArray<FVector2f>&& InGridXY);
+
+	// LOD chain variant: each LOD has its own topology and vertex data, and the proxy picks one per view from
+	// screen size. Producers only need to generate and submit the LOD reported by GetRequiredLOD().
+	void SetLODChain(TArray<FDirectProxyLODTopology>&& InLODs);
+
+	int32 GetNumLODs() const { return LODs.Num(); }
+
+	// Finest LOD any view needed in the last rendered frame; the LOD worth generating next
+	int32 GetRequiredLOD() const;
+
+	int32 GetNumVertices(int32 LODIndex = 0) const;
+
+	bool IsHeightFieldMode() const;
+
+	// Returns a writable frame sized for the given LOD's topology. Fill it and pass it to SubmitFrame.
+	// With bPreserveContents the frame starts out holding the last data submitted for that LOD, so callers only
+	// need to rewrite what changed. That reuses the last frame in place when the render thread is done with it.
+	FDirectProxyFrameRef AcquireFrame(bool bPreserveContents = false, int32 LODIndex = 0);
+
+	// Hands a filled frame to the render thread without copying it. The frame must not be written after this call.
+	void SubmitFrame(const FDirectProxyFrameRef& Frame);
+
+	// Partial submit: only the given vertex ranges are uploaded. The frame must come from AcquireFrame(true).
+	void SubmitFrame(const FDirectProxyFrameRef& Frame, TConstArrayView<FDirectProxyDirtyRange> DirtyRanges);
+
+	// Partial submit covering every vertex used by the given sections. The frame must come from AcquireFrame(true).
+	void SubmitSections(const FDirectProxyFrameRef& Frame, TConstArrayView<int32> SectionIndices);
+
+	// Vertices referenced by a section of a LOD, for building dirty ranges
+	FDirectProxyDirtyRange GetSectionVertexRange(int32 SectionIndex, int32 LODIndex = 0) const;
+
+	int32 GetNumSections() const { return Sections.Num(); }
+	const TArray<FDirectProxyMeshSection>& GetSections() const { return Sections; }
+
+	// Which optional streams the proxy binds; changing them recreates the proxy
+	void SetVertexStreams(EDirectProxyVertexStreams InStreams);
+	EDirectProxyVertexStreams GetVertexStreams() const { return VertexStreams; }
+
+	// GPU bytes per vertex the proxy keeps resident across all LODs, including every buffered frame; 0 without a proxy
+	float GetResidentBytesPerVertex() const;
+
+	// Shows or hides a section without recreating the scene proxy
+	void SetSectionVisible(int32 SectionIndex, bool bNewVisibility);
+	bool IsSectionVisible(int32 SectionIndex) const;
+
+	// Convenience wrapper that copies caller-owned arrays into a pooled frame and submits it.
+	// Callers that can write straight into AcquireFrame() avoid that copy.
 	void UpdateDynamicData(const TArray<FVector3f>& InPositions, const TArray<FVector3f>& InNormals);
 
 	// Set fixed bounds to avoid per-frame O(N) bounds recalculation.
+	// Without them the bounds follow the submitted frames: each frame's AABB is reduced with SIMD (on worker threads
+	// for large meshes) and the padded bounds are only updated when the mesh leaves them or shrinks well inside them.
+	// Pass an invalid box to go back to automatic bounds.
 	void SetFixedBounds(const FBox& InBounds);
 
+	// Padding added to automatic bounds, as a fraction of their size
+	void SetAutoBoundsPadding(float InPadding) { AutoBoundsPadding = FMath::Max(InPadding, 0.0f); }
+
+	// Opt into 16-bit positions encoded relative to the fixed bounds; only takes effect while fixed bounds are set.
+	// With a Tolerance above zero every submitted frame measures its largest encoding error and warns when it exceeds it.
+	void SetPositionFormat(EDirectProxyPositionFormat InFormat, float InTolerance = 0.0f);
+
+	// Quantization applies to full positions only, not to height field frames
+	bool IsPositionQuantized() const { return PositionFormat == EDirectProxyPositionFormat::Quantized16 && LocalBounds.IsValid && !IsHeightFieldMode(); }
+
+	// Worst case distance between a position and its quantized value for the current bounds
+	float GetMaxQuantizationError() const;
+
+	// Largest error measured in the last submitted frame (only measured with a tolerance set)
+	float GetLastQuantizationError() const { return LastQuantizationError; }
+
+	// UActorComponent interface; only ticks while frames are arriving, to notice when they stop
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// UObject interface
+	virtual void BeginDestroy() override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
 	// UPrimitiveComponent interface
 	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
-	virtual int32 GetNumMaterials() const override { return 1; }
+	virtual int32 GetNumMaterials() const override;
 	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+	virtual FBoxSphereBounds CalcLocalBounds() const override;
+	virtual FMatrix GetRenderMatrix() const override;
 
-	bool HasValidMeshData() const { return NumVertices > 0 && Indices.Num() > 0; }
+	bool HasValidMeshData() const;
 
 private:
-	// Static topology (set once, triggers proxy recreation)
-	TArray<uint32> Indices;
-	TArray<FVector2f> TexCoords;
-	int32 NumVertices = 0;
+	struct FLODState
+	{
+		// Static topology (set once, triggers proxy recreation), shared with every component using identical data
+		FDirectProxyTopologyPtr Topology;
 
-	// Dynamic data (updated per frame, kept for proxy recreation)
-	TArray<FVector3f> Positions;
-	TArray<FVector3f> Normals;
+		// Most recently submitted frame for this LOD, kept for proxy recreation and preserved acquires
+		FDirectProxyFramePtr LatestFrame;
+
+		float ScreenSize = 0.0f;
+	};
+
+	// LOD 0 is the full resolution mesh; SetStaticTopology makes a chain of one
+	TArray<FLODState> LODs;
+
+	// LOD of the most recently submitted frame, which a new proxy starts out drawing
+	int32 LatestLOD = 0;
+
+	// Per-component section state; always at least one section once a topology is set
+	TArray<FDirectProxyMeshSection> Sections;
+
+	EDirectProxyVertexStreams VertexStreams = EDirectProxyVertexStreams::VertexColor;
+
+	static int32 GetNumMaterialsForSections(TConstArrayView<FDirectProxyMeshSection> InSections);
+	void ReleaseTopologies();
+
+	// Re-prepares every LOD's last frame, after a change to how positions are encoded
+	void ResubmitLatestFrames();
+
+	// Hands a prepared frame to the scene proxy's update mailbox
+	void PostFrameToProxy(const FDirectProxyFrameRef& Frame, TConstArrayView<FDirectProxyDirtyRange> DirtyRanges);
+
+	EDirectProxyFrameLayout GetFrameLayout() const;
+
+	// Recycles frames once the render thread is done with them
+	TSharedPtr<FDirectProxyFramePool, ESPMode::ThreadSafe> FramePool;
+
+	// LOD selection reported back by the scene proxy
+	TSharedPtr<FDirectProxyLODFeedback, ESPMode::ThreadSafe> LODFeedback;
+
+	// Maps quantized [0, 1] positions back into the fixed bounds
+	FMatrix GetDequantizationMatrix() const;
 
 	// Cached bounds
 	FBox LocalBounds;
+
+	// Padded bounds of the submitted frames, used while no fixed bounds are set
+	FBox AutoBounds = FBox(ForceInit);
+	float AutoBoundsPadding = 0.1f;
+
+	// Automatic bounds are rebuilt once the mesh's extent drops below this fraction of theirs
+	static constexpr float AutoBoundsShrinkThreshold = 0.5f;
+
+	void UpdateAutoBounds(const FBox& TightBounds, bool bAllowShrink);
+
+	EDirectProxyPositionFormat PositionFormat = EDirectProxyPositionFormat::Float32;
+	float QuantizationTolerance = 0.0f;
+	float LastQuantizationError = 0.0f;
+	bool bWarnedQuantizationError = false;
+
+	// Ticks since the last submit; the proxy goes back to cached static draws after r.DirectProxyMesh.StaticDrawIdleFrames
+	int32 IdleFrames = 0;
 };
@@ -3,6 +3,7 @@
 // Example heightfield grid animated with sine and cosine waves
 
 #include "HeightFieldAnimatedActor.h"
+#include "Async/ParallelFor.h"
 
 AHeightFieldAnimatedActor::AHeightFieldAnimatedActor()
 {
@@ -15,7 +16,7 @@ AHeightFieldAnimatedActor::AHeightFieldAnimatedActor()
 void AHeightFieldAnimatedActor::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
-	SetActorTickEnabled(AnimateMesh);
+	SetActorTickEnabled(AnimateMesh || TerrainLOD.bEnabled);
 
 	if (bRequiresMeshRebuild || MeshComponent->GetNumSections() == 0)
 	{
@@ -39,7 +40,7 @@ void AHeightFieldAnimatedActor::PostEditChangeProperty(FPropertyChangedEvent& Pr
 void AHeightFieldAnimatedActor::PostLoad()
 {
 	Super::PostLoad();
-	SetActorTickEnabled(AnimateMesh);
+	SetActorTickEnabled(AnimateMesh || TerrainLOD.bEnabled);
 	bMeshCreated = false;
 	GenerateMesh();
 	bRequiresMeshRebuild = false;
@@ -78,38 +79,108 @@ void AHeightFieldAnimatedActor::GeneratePoints()
 {
 	// Setup example height data
 	// Combine variations of sine and cosine to create some variable waves
-	// TODO Convert this to use a parallel for
-	int32 PointIndex = 0;
-	MaxHeightValue = 0.0f;
+	const FHeightFieldWave Wave = GetWave();
+	const bool bUseTables = UseHeightFieldWaveTables();
+	if (bUseTables)
+	{
+		// Each term is a cosine of X times a sine of Y, so the trig only has to be done once per row and column
+		WaveTables.Build(Wave, LengthSections + 1, WidthSections + 1, 1, LengthSections, WidthSections);
+	}
 
-	for (int32 X = 0; X < LengthSections + 1; X++)
+	// Rows are independent, so bands of rows go to worker threads; small grids stay on this thread
+	const int32 NumRows = LengthSections + 1;
+	const int32 NumColumns = WidthSections + 1;
+	const int32 RowsPerBand = FMath::Max(1, 4096 / NumColumns);
+	const int32 NumBands = FMath::DivideAndRoundUp(NumRows, RowsPerBand);
+	ParallelFor(NumBands, [this, &Wave, bUseTables, NumRows, NumColumns, RowsPerBand](int32 BandIndex)
 	{
-		for (int32 Y = 0; Y < WidthSections + 1; Y++)
+		const int32 EndRow = FMath::Min((BandIndex + 1) * RowsPerBand, NumRows);
+		for (int32 X = BandIndex * RowsPerBand; X < EndRow; X++)
 		{
-			// Just some quick hardcoded offset numbers in there
-			const float ValueOne = FMath::Cos((X + CurrentAnimationFrameX)*ScaleFactor) * FMath::Sin((Y + CurrentAnimationFrameY)*ScaleFactor);
-			const float ValueTwo = FMath::Cos((X + CurrentAnimationFrameX*0.7f)*ScaleFactor*2.5f) * FMath::Sin((Y - CurrentAnimationFrameY*0.7f)*ScaleFactor*2.5f);
-			const float AvgValue = ((ValueOne + ValueTwo) / 2) * Size.Z;
-			HeightValues[PointIndex++] = AvgValue;
-
-			if (AvgValue > MaxHeightValue)
+			float* RowHeights = HeightValues.GetData() + X * NumColumns;
+			if (bUseTables)
 			{
-				MaxHeightValue = AvgValue;
+				WaveTables.FillRow(X, RowHeights);
+			}
+			else
+			{
+				for (int32 Y = 0; Y < NumColumns; Y++)
+				{
+					RowHeights[Y] = Wave.Evaluate(X, Y);
+				}
 			}
 		}
+	}, NumBands <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	MaxHeightValue = 0.0f;
+	for (const float Height : HeightValues)
+	{
+		MaxHeightValue = FMath::Max(MaxHeightValue, Height);
 	}
 }
 
+FHeightFieldWave AHeightFieldAnimatedActor::GetWave() const
+{
+	FHeightFieldWave Wave;
+	Wave.ScaleFactor = ScaleFactor;
+	Wave.FrameX = CurrentAnimationFrameX;
+	Wave.FrameY = CurrentAnimationFrameY;
+	Wave.Amplitude = static_cast<float>(Size.Z);
+	return Wave;
+}
+
 void AHeightFieldAnimatedActor::Tick(float DeltaSeconds)
 {
-	if (AnimateMesh)
+	// Editor viewports only tick this actor for terrain LOD patch selection; like the uniform grid, it only
+	// animates in game worlds
+	const bool bAnimate = AnimateMesh && GetWorld()->IsGameWorld();
+	if (bAnimate)
 	{
 		CurrentAnimationFrameX += DeltaSeconds * AnimationSpeedX;
 		CurrentAnimationFrameY += DeltaSeconds * AnimationSpeedY;
+	}
+
+	if (TerrainLOD.bEnabled && bMeshCreated)
+	{
+		// Patches follow the camera; animated heights rebuild every selected patch
+		UpdateTerrain(bAnimate);
+	}
+	else if (bAnimate)
+	{
 		GenerateMesh();
 	}
 }
 
+void AHeightFieldAnimatedActor::UpdateTerrain(bool bHeightsChanged)
+{
+	FHeightFieldTerrainLOD::GetLocalViewLocations(this, TerrainViews);
+	const FHeightFieldWave Wave = GetWave();
+	const bool bUseTables = UseHeightFieldWaveTables();
+	TerrainLODState.Update(MeshComponent, Material, TerrainViews, [this, &Wave, bUseTables](int32 FirstX, int32 FirstY, int32 Stride, int32 NumRows, int32 NumColumns, float* OutHeights)
+	{
+		// Called for several patches at once, so every call has its own tables
+		if (bUseTables)
+		{
+			FHeightFieldWaveTables PatchTables;
+			PatchTables.Build(Wave, NumRows, NumColumns, Stride, LengthSections, WidthSections, FirstX, FirstY);
+			for (int32 Row = 0; Row < NumRows; Row++)
+			{
+				PatchTables.FillRow(Row, OutHeights + Row * NumColumns);
+			}
+			return;
+		}
+
+		for (int32 Row = 0; Row < NumRows; Row++)
+		{
+			const int32 X = FMath::Clamp(FirstX + Row * Stride, 0, LengthSections);
+			for (int32 Column = 0; Column < NumColumns; Column++)
+			{
+				OutHeights[Row * NumColumns + Column] = Wave.Evaluate(X, FMath::Clamp(FirstY + Column * Stride, 0, WidthSections));
+			}
+		}
+	}, bHeightsChanged);
+}
+
 void AHeightFieldAnimatedActor::GenerateMesh()
 {
 	if (!IsValid(MeshComponent))
@@ -124,6 +195,18 @@ void AHeightFieldAnimatedActor::GenerateMesh()
 		return;
 	}
 
+	if (TerrainLOD.bEnabled)
+	{
+		// Patches sample the wave directly, so the uniform grid buffers aren't needed
+		if (!bMeshCreated)
+		{
+			TerrainLODState.Init(MeshComponent, TerrainLOD, NormalMode, Size, LengthSections, WidthSections, -static_cast<float>(Size.Z), static_cast<float>(Size.Z));
+			bMeshCreated = true;
+		}
+		UpdateTerrain(true);
+		return;
+	}
+
 	SetupMeshBuffers();
 	GeneratePoints();
 
@@ -186,11 +269,19 @@ void AHeightFieldAnimatedActor::GenerateGrid(const FVector2D InSize, const int32
 				Triangles[TriangleIndex++] = TopRightIndex;
 
 				// Normals
-				const FVector NormalCurrent = FVector::CrossProduct(Positions[BottomLeftIndex] - Positions[TopLeftIndex], Positions[TopLeftIndex] - Positions[TopRightIndex]).GetSafeNormal();
-				Normals[BottomLeftIndex] = Normals[BottomRightIndex] = Normals[TopRightIndex] = Normals[TopLeftIndex] = NormalCurrent;
+				if (NormalMode == EHeightFieldNormalMode::Faceted)
+				{
+					const FVector NormalCurrent = FVector::CrossProduct(Positions[BottomLeftIndex] - Positions[TopLeftIndex], Positions[TopLeftIndex] - Positions[TopRightIndex]).GetSafeNormal();
+					Normals[BottomLeftIndex] = Normals[BottomRightIndex] = Normals[TopRightIndex] = Normals[TopLeftIndex] = NormalCurrent;
+				}
 			}
 		}
 	}
+
+	if (NormalMode == EHeightFieldNormalMode::Smooth)
+	{
+		UpdateSmoothNormals(InSize, InLengthSections, InWidthSections, InHeightValues);
+	}
 }
 
 void AHeightFieldAnimatedActor::UpdatePositionsAndNormals(const FVector2D InSize, const int32 InLengthSections, const int32 InWidthSections, const TArray<float>& InHeightValues)
@@ -205,7 +296,7 @@ void AHeightFieldAnimatedActor::UpdatePositionsAndNormals(const FVector2D InSize
 			const int32 NewVertIndex = VertexIndex++;
 			Positions[NewVertIndex] = FVector(X * SectionSize.X, Y * SectionSize.Y, InHeightValues[NewVertIndex]);
 
-			if (X > 0 && Y > 0)
+			if (X > 0 && Y > 0 && NormalMode == EHeightFieldNormalMode::Faceted)
 			{
 				const int32 TopRightIndex = (X * (InWidthSections + 1)) + Y;
 				const int32 TopLeftIndex = TopRightIndex - 1;
@@ -217,4 +308,33 @@ void AHeightFieldAnimatedActor::UpdatePositionsAndNormals(const FVector2D InSize
 			}
 		}
 	}
+
+	if (NormalMode == EHeightFieldNormalMode::Smooth)
+	{
+		UpdateSmoothNormals(InSize, InLengthSections, InWidthSections, InHeightValues);
+	}
+}
+
+// Smooth normals straight from the height grid: every vertex is computed on its own, so there is no overwrite order
+void AHeightFieldAnimatedActor::UpdateSmoothNormals(const FVector2D InSize, const int32 InLengthSections, const int32 InWidthSections, const TArray<float>& InHeightValues)
+{
+	const FVector2D SectionSize = FVector2D(InSize.X / InLengthSections, InSize.Y / InWidthSections);
+
+	TArray<float, TInlineAllocator<1024>> RowCoords;
+	TArray<float, TInlineAllocator<1024>> ColumnCoords;
+	RowCoords.SetNumUninitialized(InLengthSections + 1);
+	ColumnCoords.SetNumUninitialized(InWidthSections + 1);
+	for (int32 X = 0; X < InLengthSections + 1; X++)
+	{
+		RowCoords[X] = static_cast<float>(X * SectionSize.X);
+	}
+	for (int32 Y = 0; Y < InWidthSections + 1; Y++)
+	{
+		ColumnCoords[Y] = static_cast<float>(Y * SectionSize.Y);
+	}
+
+	for (int32 X = 0; X < InLengthSections + 1; X++)
+	{
+		FillSmoothGridNormalsRow(X, InHeightValues.GetData(), 1, RowCoords, ColumnCoords, Normals.GetData() + X * (InWidthSections + 1));
+	}
 }
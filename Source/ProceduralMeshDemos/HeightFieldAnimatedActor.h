@@ -7,6 +7,8 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "RuntimeProceduralMeshComponent.h"
+#include "HeightFieldWave.h"
+#include "HeightFieldTerrainLOD.h"
 #include "HeightFieldAnimatedActor.generated.h"
 
 UCLASS()
@@ -41,6 +43,13 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
 	float AnimationSpeedY = 4.5f;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	EHeightFieldNormalMode NormalMode = EHeightFieldNormalMode::Faceted;
+
+	// Draw the grid as distance based LOD patches instead of one uniform mesh
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	FHeightFieldTerrainLODSettings TerrainLOD;
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 	virtual void PostLoad() override;
 #if WITH_EDITOR
@@ -49,6 +58,9 @@ public:
 
 	virtual void Tick(float DeltaSeconds) override;
 
+	// Terrain LOD follows the editor camera too, without animating there
+	virtual bool ShouldTickIfViewportsOnly() const override { return TerrainLOD.bEnabled; }
+
 protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Transient)
 	URuntimeProceduralMeshComponent* MeshComponent;
@@ -59,10 +71,16 @@ protected:
 private:
 	void GenerateMesh();
 	void GeneratePoints();
+	void UpdateTerrain(bool bHeightsChanged);
+	FHeightFieldWave GetWave() const;
 	void GenerateGrid(const FVector2D InSize, const int32 InLengthSections, const int32 InWidthSections, const TArray<float>& InHeightValues);
 	void UpdatePositionsAndNormals(const FVector2D InSize, const int32 InLengthSections, const int32 InWidthSections, const TArray<float>& InHeightValues);
+	void UpdateSmoothNormals(const FVector2D InSize, const int32 InLengthSections, const int32 InWidthSections, const TArray<float>& InHeightValues);
 
 	TArray<float> HeightValues;
+	FHeightFieldWaveTables WaveTables;
+	FHeightFieldTerrainLOD TerrainLODState;
+	TArray<FVector> TerrainViews;
 	float MaxHeightValue = 0.0f;
 	bool bMeshCreated = false;
 	bool bRequiresMeshRebuild = false;
@@ -5,6 +5,7 @@
 
 #include "HeightFieldDirectProxyActor.h"
 #include "DirectProxyMeshComponent.h"
+#include "Async/ParallelFor.h"
 
 AHeightFieldDirectProxyActor::AHeightFieldDirectProxyActor()
 {
@@ -17,7 +18,7 @@ AHeightFieldDirectProxyActor::AHeightFieldDirectProxyActor()
 void AHeightFieldDirectProxyActor::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
-	SetActorTickEnabled(AnimateMesh);
+	SetActorTickEnabled(AnimateMesh || GetEffectiveNumLODs() > 1);
 
 	if (bRequiresMeshRebuild || !bMeshCreated)
 	{
@@ -41,7 +42,7 @@ void AHeightFieldDirectProxyActor::PostEditChangeProperty(FPropertyChangedEvent&
 void AHeightFieldDirectProxyActor::PostLoad()
 {
 	Super::PostLoad();
-	SetActorTickEnabled(AnimateMesh);
+	SetActorTickEnabled(AnimateMesh || GetEffectiveNumLODs() > 1);
 	bMeshCreated = false;
 	GenerateMesh();
 	bRequiresMeshRebuild = false;
@@ -55,40 +56,218 @@ void AHeightFieldDirectProxyActor::Tick(float DeltaSeconds)
 		CurrentAnimationFrameY += DeltaSeconds * AnimationSpeedY;
 		GenerateMesh();
 	}
+	else if (bMeshCreated && MeshComponent->GetRequiredLOD() != GeneratedLOD)
+	{
+		// Static mesh: only regenerate when the camera needs a different LOD
+		GenerateMesh();
+	}
+}
+
+FHeightFieldWave AHeightFieldDirectProxyActor::GetWave() const
+{
+	FHeightFieldWave Wave;
+	Wave.ScaleFactor = ScaleFactor;
+	Wave.FrameX = CurrentAnimationFrameX;
+	Wave.FrameY = CurrentAnimationFrameY;
+	Wave.Amplitude = static_cast<float>(Size.Z);
+	return Wave;
+}
+
+// Rows per ParallelFor task, sized so each task fills a few thousand vertices
+static int32 GetRowsPerBand(int32 NumColumns)
+{
+	return FMath::Max(1, 4096 / NumColumns);
+}
+
+// Runs Kernel(Row) for every grid row, in bands of rows on worker threads. Small grids stay on the calling thread.
+template <typename KernelType>
+static void ForEachRowBand(int32 NumRows, int32 NumColumns, KernelType&& Kernel)
+{
+	const int32 RowsPerBand = GetRowsPerBand(NumColumns);
+	const int32 NumBands = FMath::DivideAndRoundUp(NumRows, RowsPerBand);
+	ParallelFor(NumBands, [&Kernel, NumRows, RowsPerBand](int32 BandIndex)
+	{
+		const int32 EndRow = FMath::Min((BandIndex + 1) * RowsPerBand, NumRows);
+		for (int32 Row = BandIndex * RowsPerBand; Row < EndRow; Row++)
+		{
+			Kernel(Row);
+		}
+	}, NumBands <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
 }
 
+// Faceted normals as a gather: every vertex takes the normal of the quad up and to the right of it (clamped at the
+// far edges), which is the quad that used to write it last when quads scattered their normal to all four corners.
+// Each vertex is written by exactly one task, so the result doesn't depend on how rows are split between threads.
+template <typename PositionFuncType>
+static void FillGridNormals(int32 LODLength, int32 LODWidth, TArray<FVector3f>& OutNormals, const PositionFuncType& GetPosition)
+{
+	const int32 NumColumns = LODWidth + 1;
+	ForEachRowBand(LODLength + 1, NumColumns, [&OutNormals, &GetPosition, LODLength, LODWidth, NumColumns](int32 X)
+	{
+		const int32 QuadX = FMath::Min(X + 1, LODLength);
+		for (int32 Y = 0; Y < NumColumns; Y++)
+		{
+			const int32 QuadY = FMath::Min(Y + 1, LODWidth);
+			const int32 TopRight = (QuadX * NumColumns) + QuadY;
+			const int32 TopLeft = TopRight - 1;
+			const int32 BottomLeft = ((QuadX - 1) * NumColumns) + QuadY - 1;
+
+			const FVector3f TopLeftPosition = GetPosition(TopLeft);
+			OutNormals[X * NumColumns + Y] = FVector3f::CrossProduct(
+				GetPosition(BottomLeft) - TopLeftPosition,
+				TopLeftPosition - GetPosition(TopRight)).GetSafeNormal();
+		}
+	});
+}
+
+// Two passes over row bands: heights first, then normals, which read the neighbouring rows
 void AHeightFieldDirectProxyActor::FillPositionsAndNormals(
 	TArray<FVector3f>& OutPositions, TArray<FVector3f>& OutNormals,
-	const FVector2D& SectionSize)
+	const FVector2D& SectionSize, int32 Stride, const FHeightFieldWaveTables* Tables) const
 {
-	int32 VertexIndex = 0;
-	for (int32 X = 0; X < LengthSections + 1; X++)
+	const int32 LODLength = GetLODLengthSections(Stride);
+	const int32 LODWidth = GetLODWidthSections(Stride);
+	const int32 NumColumns = LODWidth + 1;
+
+	ForEachRowBand(LODLength + 1, NumColumns, [&OutPositions, &SectionSize, Tables, Stride, NumColumns, this](int32 X)
+	{
+		FVector3f* RowPositions = OutPositions.GetData() + X * NumColumns;
+		const int32 SampleX = FMath::Min(X * Stride, LengthSections);
+		for (int32 Y = 0; Y < NumColumns; Y++)
+		{
+			const int32 SampleY = FMath::Min(Y * Stride, WidthSections);
+			RowPositions[Y] = FVector3f(SampleX * SectionSize.X, SampleY * SectionSize.Y, Tables ? 0.0f : GetHeight(SampleX, SampleY));
+		}
+		if (Tables)
+		{
+			// Heights straight into the Z of each position
+			Tables->FillRow(X, &RowPositions[0].Z, sizeof(FVector3f) / sizeof(float));
+		}
+	});
+
+	if (NormalMode == EHeightFieldNormalMode::Smooth)
 	{
-		for (int32 Y = 0; Y < WidthSections + 1; Y++)
+		FillSmoothNormals(&OutPositions[0].Z, sizeof(FVector3f) / sizeof(float), OutNormals, SectionSize, Stride);
+		return;
+	}
+
+	FillGridNormals(LODLength, LODWidth, OutNormals, [&OutPositions](int32 Idx)
+	{
+		return OutPositions[Idx];
+	});
+}
+
+// Same as FillPositionsAndNormals, with X/Y taken from the grid instead of a position array
+void AHeightFieldDirectProxyActor::FillHeightsAndNormals(
+	TArray<float>& OutHeights, TArray<FVector3f>& OutNormals,
+	const FVector2D& SectionSize, int32 Stride, const FHeightFieldWaveTables* Tables) const
+{
+	const int32 LODLength = GetLODLengthSections(Stride);
+	const int32 LODWidth = GetLODWidthSections(Stride);
+	const int32 NumColumns = LODWidth + 1;
+
+	ForEachRowBand(LODLength + 1, NumColumns, [&OutHeights, Tables, Stride, NumColumns, this](int32 X)
+	{
+		if (Tables)
+		{
+			Tables->FillRow(X, OutHeights.GetData() + X * NumColumns);
+			return;
+		}
+
+		const int32 SampleX = FMath::Min(X * Stride, LengthSections);
+		for (int32 Y = 0; Y < NumColumns; Y++)
 		{
-			const int32 Idx = VertexIndex++;
+			OutHeights[X * NumColumns + Y] = GetHeight(SampleX, FMath::Min(Y * Stride, WidthSections));
+		}
+	});
+
+	if (NormalMode == EHeightFieldNormalMode::Smooth)
+	{
+		FillSmoothNormals(OutHeights.GetData(), 1, OutNormals, SectionSize, Stride);
+		return;
+	}
+
+	FillGridNormals(LODLength, LODWidth, OutNormals, [&OutHeights, &SectionSize, Stride, NumColumns, this](int32 Idx)
+	{
+		const int32 SampleX = FMath::Min((Idx / NumColumns) * Stride, LengthSections);
+		const int32 SampleY = FMath::Min((Idx % NumColumns) * Stride, WidthSections);
+		return FVector3f(SampleX * SectionSize.X, SampleY * SectionSize.Y, OutHeights[Idx]);
+	});
+}
 
-			// Inline height computation (avoids intermediate HeightValues array)
-			const float ValueOne = FMath::Cos((X + CurrentAnimationFrameX) * ScaleFactor) * FMath::Sin((Y + CurrentAnimationFrameY) * ScaleFactor);
-			const float ValueTwo = FMath::Cos((X + CurrentAnimationFrameX * 0.7f) * ScaleFactor * 2.5f) * FMath::Sin((Y - CurrentAnimationFrameY * 0.7f) * ScaleFactor * 2.5f);
-			const float HeightValue = ((ValueOne + ValueTwo) * 0.5f) * Size.Z;
+// Central-difference normals from the heights of the whole LOD, one row band per task
+void AHeightFieldDirectProxyActor::FillSmoothNormals(const float* Heights, int32 HeightStride, TArray<FVector3f>& OutNormals,
+	const FVector2D& SectionSize, int32 Stride) const
+{
+	TArray<float, TInlineAllocator<1024>> RowCoords;
+	TArray<float, TInlineAllocator<1024>> ColumnCoords;
+	RowCoords.SetNumUninitialized(GetLODLengthSections(Stride) + 1);
+	ColumnCoords.SetNumUninitialized(GetLODWidthSections(Stride) + 1);
+	for (int32 X = 0; X < RowCoords.Num(); X++)
+	{
+		RowCoords[X] = static_cast<float>(FMath::Min(X * Stride, LengthSections) * SectionSize.X);
+	}
+	for (int32 Y = 0; Y < ColumnCoords.Num(); Y++)
+	{
+		ColumnCoords[Y] = static_cast<float>(FMath::Min(Y * Stride, WidthSections) * SectionSize.Y);
+	}
+
+	const int32 NumColumns = ColumnCoords.Num();
+	ForEachRowBand(RowCoords.Num(), NumColumns, [&OutNormals, &RowCoords, &ColumnCoords, Heights, HeightStride, NumColumns](int32 X)
+	{
+		FillSmoothGridNormalsRow(X, Heights, HeightStride, RowCoords, ColumnCoords, OutNormals.GetData() + X * NumColumns);
+	});
+}
+
+// Grid topology for one LOD. Points are clamped to the far edge, so every LOD covers the same area.
+FDirectProxyLODTopology AHeightFieldDirectProxyActor::BuildLODTopology(int32 Stride, const FVector2D& SectionSize) const
+{
+	const int32 LODLength = GetLODLengthSections(Stride);
+	const int32 LODWidth = GetLODWidthSections(Stride);
+	const int32 NumVerts = (LODLength + 1) * (LODWidth + 1);
+	const int32 TriangleCount = LODLength * LODWidth * 2 * 3;
+	const float LengthSectionsF = static_cast<float>(LengthSections);
+	const float WidthSectionsF = static_cast<float>(WidthSections);
 
-			OutPositions[Idx] = FVector3f(X * SectionSize.X, Y * SectionSize.Y, HeightValue);
+	FDirectProxyLODTopology LOD;
+	LOD.NumVertices = NumVerts;
+	LOD.Indices.AddUninitialized(TriangleCount);
+	LOD.TexCoords.AddUninitialized(NumVerts);
+	LOD.GridXY.AddUninitialized(StreamHeightsOnly ? NumVerts : 0);
+
+	// Build topology (indices + UVs)
+	int32 TriangleIndex = 0;
+	for (int32 X = 0; X < LODLength + 1; X++)
+	{
+		for (int32 Y = 0; Y < LODWidth + 1; Y++)
+		{
+			const int32 Idx = X * (LODWidth + 1) + Y;
+			const int32 SampleX = FMath::Min(X * Stride, LengthSections);
+			const int32 SampleY = FMath::Min(Y * Stride, WidthSections);
+			LOD.TexCoords[Idx] = FVector2f(static_cast<float>(SampleX) / LengthSectionsF, static_cast<float>(SampleY) / WidthSectionsF);
+			if (StreamHeightsOnly)
+			{
+				LOD.GridXY[Idx] = FVector2f(SampleX * SectionSize.X, SampleY * SectionSize.Y);
+			}
 
 			if (X > 0 && Y > 0)
 			{
-				const int32 TopRight = (X * (WidthSections + 1)) + Y;
+				const int32 TopRight = (X * (LODWidth + 1)) + Y;
 				const int32 TopLeft = TopRight - 1;
-				const int32 BottomRight = ((X - 1) * (WidthSections + 1)) + Y;
+				const int32 BottomRight = ((X - 1) * (LODWidth + 1)) + Y;
 				const int32 BottomLeft = BottomRight - 1;
 
-				const FVector3f NormalCurrent = FVector3f::CrossProduct(
-					OutPositions[BottomLeft] - OutPositions[TopLeft],
-					OutPositions[TopLeft] - OutPositions[TopRight]).GetSafeNormal();
-				OutNormals[BottomLeft] = OutNormals[BottomRight] = OutNormals[TopRight] = OutNormals[TopLeft] = NormalCurrent;
+				LOD.Indices[TriangleIndex++] = BottomLeft;
+				LOD.Indices[TriangleIndex++] = TopRight;
+				LOD.Indices[TriangleIndex++] = TopLeft;
+
+				LOD.Indices[TriangleIndex++] = BottomLeft;
+				LOD.Indices[TriangleIndex++] = BottomRight;
+				LOD.Indices[TriangleIndex++] = TopRight;
 			}
 		}
 	}
+	return LOD;
 }
 
 void AHeightFieldDirectProxyActor::GenerateMesh()
@@ -104,69 +283,52 @@ void AHeightFieldDirectProxyActor::GenerateMesh()
 		return;
 	}
 
-	const int32 NumVerts = (LengthSections + 1) * (WidthSections + 1);
 	const FVector2D SectionSize = FVector2D(Size.X / LengthSections, Size.Y / WidthSections);
 
 	if (!bMeshCreated)
 	{
-		// Full rebuild: topology + positions + normals + UVs
-		const int32 TriangleCount = LengthSections * WidthSections * 2 * 3;
-		const float LengthSectionsF = static_cast<float>(LengthSections);
-		const float WidthSectionsF = static_cast<float>(WidthSections);
-
-		TArray<uint32> Indices;
-		TArray<FVector2f> TexCoords;
-		Indices.AddUninitialized(TriangleCount);
-		TexCoords.AddUninitialized(NumVerts);
-
-		// Resize persistent buffers
-		Positions.SetNumUninitialized(NumVerts);
-		Normals.SetNumUninitialized(NumVerts);
-
-		// Build topology (indices + UVs)
-		int32 TriangleIndex = 0;
-		for (int32 X = 0; X < LengthSections + 1; X++)
+		// Full rebuild: topology + UVs for every LOD, each half the resolution of the previous one
+		TArray<FDirectProxyLODTopology> LODs;
+		for (int32 LODIndex = 0; LODIndex < GetEffectiveNumLODs(); LODIndex++)
 		{
-			for (int32 Y = 0; Y < WidthSections + 1; Y++)
-			{
-				const int32 Idx = X * (WidthSections + 1) + Y;
-				TexCoords[Idx] = FVector2f(static_cast<float>(X) / LengthSectionsF, static_cast<float>(Y) / WidthSectionsF);
-
-				if (X > 0 && Y > 0)
-				{
-					const int32 TopRight = (X * (WidthSections + 1)) + Y;
-					const int32 TopLeft = TopRight - 1;
-					const int32 BottomRight = ((X - 1) * (WidthSections + 1)) + Y;
-					const int32 BottomLeft = BottomRight - 1;
-
-					Indices[TriangleIndex++] = BottomLeft;
-					Indices[TriangleIndex++] = TopRight;
-					Indices[TriangleIndex++] = TopLeft;
-
-					Indices[TriangleIndex++] = BottomLeft;
-					Indices[TriangleIndex++] = BottomRight;
-					Indices[TriangleIndex++] = TopRight;
-				}
-			}
+			FDirectProxyLODTopology& LOD = LODs.Add_GetRef(BuildLODTopology(1 << LODIndex, SectionSize));
+			LOD.ScreenSize = LODIndex > 0 ? 1.0f / static_cast<float>(1 << LODIndex) : 0.0f;
 		}
 
-		// Fill positions + normals
-		FillPositionsAndNormals(Positions, Normals, SectionSize);
-
-		// Sync material and upload
+		// Sync material and set topology first, so frames are sized for the new vertex count
 		MeshComponent->SetMaterial(0, Material);
-		MeshComponent->SetStaticTopology(MoveTemp(Indices), MoveTemp(TexCoords), NumVerts);
-		MeshComponent->UpdateDynamicData(Positions, Normals);
+		MeshComponent->SetLODChain(MoveTemp(LODs));
 
-		// Set analytical bounds: XY from grid size, Z conservative from wave amplitude
+		// Set analytical bounds: XY from grid size, Z conservative from wave amplitude.
+		// Done before submitting since quantized positions are encoded relative to these bounds.
+		MeshComponent->SetPositionFormat(QuantizePositions ? EDirectProxyPositionFormat::Quantized16 : EDirectProxyPositionFormat::Float32);
 		MeshComponent->SetFixedBounds(FBox(FVector(0, 0, -Size.Z), FVector(Size.X, Size.Y, Size.Z)));
 
 		bMeshCreated = true;
 	}
+
+	// Only the LOD the views asked for last frame is generated
+	GeneratedLOD = MeshComponent->GetRequiredLOD();
+	const int32 Stride = 1 << GeneratedLOD;
+
+	// Fill positions (or just heights) + normals straight into a pooled frame and hand it to the render thread.
+	// After the first build this is the whole per-frame path: no allocations, no copies.
+	// The wave is separable, so one cos per row and one sin per column replace four trig calls per vertex
+	const FHeightFieldWaveTables* Tables = nullptr;
+	if (UseHeightFieldWaveTables())
+	{
+		WaveTables.Build(GetWave(), GetLODLengthSections(Stride) + 1, GetLODWidthSections(Stride) + 1, Stride, LengthSections, WidthSections);
+		Tables = &WaveTables;
+	}
+
+	const FDirectProxyFrameRef Frame = MeshComponent->AcquireFrame(false, GeneratedLOD);
+	if (MeshComponent->IsHeightFieldMode())
+	{
+		FillHeightsAndNormals(Frame->Heights, Frame->Normals, SectionSize, Stride, Tables);
+	}
 	else
 	{
-		// Fast path: only recompute positions and normals (no allocations)
-		FillPositionsAndNormals(Positions, Normals, SectionSize);
-		MeshComponent->UpdateDynamicData(Positions, Normals);
+		FillPositionsAndNormals(Frame->Positions, Frame->Normals, SectionSize, Stride, Tables);
 	}
+	MeshComponent->SubmitFrame(Frame);
 }
@@ -7,9 +7,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "HeightFieldWave.h"
 #include "HeightFieldDirectProxyActor.generated.h"
 
 class UDirectProxyMeshComponent;
+struct FDirectProxyLODTopology;
 
 UCLASS()
 class PROCEDURALMESHDEMOS_API AHeightFieldDirectProxyActor : public AActor
@@ -43,6 +45,23 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
 	float AnimationSpeedY = 4.5f;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	EHeightFieldNormalMode NormalMode = EHeightFieldNormalMode::Faceted;
+
+	// Upload positions as 16-bit values relative to the mesh bounds (8 instead of 12 bytes per vertex)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	bool QuantizePositions = false;
+
+	// Only stream heights and normals (8 bytes per vertex); X/Y are uploaded once and a compute shader expands
+	// them into the vertex streams. Takes precedence over QuantizePositions.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	bool StreamHeightsOnly = false;
+
+	// Number of LODs, each sampling every 2nd, 4th or 8th grid point of the previous resolution.
+	// Only the LOD the camera currently needs is generated and uploaded.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters", meta = (ClampMin = "1", ClampMax = "4"))
+	int32 NumLODs = 1;
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 	virtual void PostLoad() override;
 #if WITH_EDITOR
@@ -60,13 +79,29 @@ protected:
 
 private:
 	void GenerateMesh();
+	FDirectProxyLODTopology BuildLODTopology(int32 Stride, const FVector2D& SectionSize) const;
+
+	// Fill a frame on worker threads, in bands of grid rows. Heights come from the wave tables when given,
+	// otherwise from the reference GetHeight, which must stay safe to call concurrently.
 	void FillPositionsAndNormals(TArray<FVector3f>& OutPositions, TArray<FVector3f>& OutNormals,
-		const FVector2D& SectionSize);
+		const FVector2D& SectionSize, int32 Stride, const FHeightFieldWaveTables* Tables) const;
+	void FillHeightsAndNormals(TArray<float>& OutHeights, TArray<FVector3f>& OutNormals,
+		const FVector2D& SectionSize, int32 Stride, const FHeightFieldWaveTables* Tables) const;
+	void FillSmoothNormals(const float* Heights, int32 HeightStride, TArray<FVector3f>& OutNormals,
+		const FVector2D& SectionSize, int32 Stride) const;
+	FHeightFieldWave GetWave() const;
+	float GetHeight(int32 X, int32 Y) const { return GetWave().Evaluate(X, Y); }
+
+	// Grid points along each axis for a LOD sampling every Stride-th point; the last one is always on the edge
+	int32 GetLODLengthSections(int32 Stride) const { return FMath::DivideAndRoundUp(LengthSections, Stride); }
+	int32 GetLODWidthSections(int32 Stride) const { return FMath::DivideAndRoundUp(WidthSections, Stride); }
+
+	int32 GetEffectiveNumLODs() const { return FMath::Clamp(NumLODs, 1, 4); }
 
-	// Persistent buffers reused each frame to avoid per-frame allocations
-	TArray<FVector3f> Positions;
-	TArray<FVector3f> Normals;
+	// Per-row and per-column trig for the LOD being generated, rebuilt every frame
+	FHeightFieldWaveTables WaveTables;
 
 	bool bMeshCreated = false;
+	int32 GeneratedLOD = 0;
 	bool bRequiresMeshRebuild = false;
 };
@@ -3,10 +3,51 @@
 // Example heightfield generated with noise
 
 #include "HeightFieldNoiseActor.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "Tasks/Task.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(LogHeightFieldNoise, Log, All);
+
+static TAutoConsoleVariable<int32> CVarHeightFieldAsyncNoise(
+	TEXT("HeightField.AsyncNoise"),
+	1,
+	TEXT("1 generates the noise heightfield on a background task (default), 0 on the game thread."),
+	ECVF_Default);
+
+// Heights are filled in bands of about this many samples, checking for cancellation in between
+static constexpr int32 NoiseJobSamplesPerBand = 262144;
+
+// One generation of the noise heightfield. Everything it reads is copied from the actor when it starts, and
+// everything it writes is its own, so the actor can change or go away while it runs.
+struct FHeightFieldNoiseJob
+{
+	uint32 GenerationId = 0;
+	FProceduralNoiseSettings Noise;
+	uint32 Seed = 0;
+	FVector Size = FVector::ZeroVector;
+	int32 LengthSections = 0;
+	int32 WidthSections = 0;
+	EHeightFieldGridVertices GridVertices = EHeightFieldGridVertices::FacetedQuads;
+	bool bTerrainLOD = false;
+	FHeightFieldTerrainLODSettings TerrainLOD;
+
+	// Set when a newer generation starts; the job stops at its next check
+	std::atomic<bool> bCancelled{false};
+
+	TArray<float> HeightValues;
+	TArray<FVector> Positions;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+	TArray<FProcMeshTangent> Tangents;
+	TArray<FVector2D> TexCoords;
+};
 
 AHeightFieldNoiseActor::AHeightFieldNoiseActor()
 {
-	PrimaryActorTick.bCanEverTick = false;
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 	MeshComponent = CreateDefaultSubobject<URuntimeProceduralMeshComponent>(TEXT("ProceduralMesh"));
 	SetRootComponent(MeshComponent);
 }
@@ -14,8 +55,10 @@ AHeightFieldNoiseActor::AHeightFieldNoiseActor()
 void AHeightFieldNoiseActor::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
+	SetActorTickEnabled(TerrainLOD.bEnabled);
 
-	if (bRequiresMeshRebuild || MeshComponent->GetNumSections() == 0)
+	// An empty mesh with a job in flight is already being generated
+	if (bRequiresMeshRebuild || (MeshComponent->GetNumSections() == 0 && !PendingJob.IsValid()))
 	{
 		GenerateMesh();
 		bRequiresMeshRebuild = false;
@@ -36,74 +79,175 @@ void AHeightFieldNoiseActor::PostEditChangeProperty(FPropertyChangedEvent& Prope
 void AHeightFieldNoiseActor::PostLoad()
 {
 	Super::PostLoad();
+	SetActorTickEnabled(TerrainLOD.bEnabled);
 	GenerateMesh();
 	bRequiresMeshRebuild = false;
 }
 
-void AHeightFieldNoiseActor::SetupMeshBuffers()
+void AHeightFieldNoiseActor::BeginDestroy()
 {
-	const int32 NumberOfPoints = (LengthSections + 1) * (WidthSections + 1);
-	const int32 VertexCount = LengthSections * WidthSections * 4; // 4x vertices per quad/section
-	const int32 TriangleCount = LengthSections * WidthSections * 2 * 3; // 2x3 vertex indexes per quad
+	CancelPendingJob();
+	Super::BeginDestroy();
+}
 
-	if (VertexCount != Positions.Num())
+void AHeightFieldNoiseActor::Tick(float DeltaSeconds)
+{
+	// Heights are static, so only patches whose LOD changed get rebuilt
+	if (TerrainLOD.bEnabled && TerrainLODState.GetNumPatches() > 0)
 	{
-		Positions.Empty();
-		Positions.AddUninitialized(VertexCount);
-		Normals.Empty();
-		Normals.AddUninitialized(VertexCount);
-		Tangents.Empty();
-		Tangents.AddUninitialized(VertexCount);
-		TexCoords.Empty();
-		TexCoords.AddUninitialized(VertexCount);
+		UpdateTerrain();
 	}
+}
 
-	if (TriangleCount != Triangles.Num())
+void AHeightFieldNoiseActor::UpdateTerrain()
+{
+	FHeightFieldTerrainLOD::GetLocalViewLocations(this, TerrainViews);
+	const int32 MaxX = HeightValues.Num() / HeightRowLength - 1;
+	const int32 MaxY = HeightRowLength - 1;
+	TerrainLODState.Update(MeshComponent, Material, TerrainViews, [this, MaxX, MaxY](int32 FirstX, int32 FirstY, int32 Stride, int32 NumRows, int32 NumColumns, float* OutHeights)
 	{
-		Triangles.Empty();
-		Triangles.AddUninitialized(TriangleCount);
+		for (int32 Row = 0; Row < NumRows; Row++)
+		{
+			const float* RowHeights = HeightValues.GetData() + FMath::Clamp(FirstX + Row * Stride, 0, MaxX) * HeightRowLength;
+			for (int32 Column = 0; Column < NumColumns; Column++)
+			{
+				OutHeights[Row * NumColumns + Column] = RowHeights[FMath::Clamp(FirstY + Column * Stride, 0, MaxY)];
+			}
+		}
+	}, false);
+}
+
+void AHeightFieldNoiseActor::GenerateMesh()
+{
+	if (!IsValid(MeshComponent))
+	{
+		return;
 	}
 
-	if (NumberOfPoints != HeightValues.Num())
+	CancelPendingJob();
+	GenerationId++;
+
+	if (Size.X < 1 || Size.Y < 1 || LengthSections < 1 || WidthSections < 1)
 	{
-		HeightValues.Empty();
-		HeightValues.AddUninitialized(NumberOfPoints);
+		MeshComponent->ClearAllMeshSections();
+		TerrainLODState = FHeightFieldTerrainLOD();
+		return;
 	}
-}
 
-void AHeightFieldNoiseActor::GeneratePoints()
-{
-	RngStream.Initialize(RandomSeed);
+	const TSharedRef<FHeightFieldNoiseJob, ESPMode::ThreadSafe> Job = MakeShared<FHeightFieldNoiseJob, ESPMode::ThreadSafe>();
+	Job->GenerationId = GenerationId;
+	Job->Noise = Noise;
+	Job->Seed = static_cast<uint32>(RandomSeed);
+	Job->Size = Size;
+	Job->LengthSections = LengthSections;
+	Job->WidthSections = WidthSections;
+	Job->GridVertices = GridVertices;
+	Job->bTerrainLOD = TerrainLOD.bEnabled;
+	Job->TerrainLOD = TerrainLOD;
+
+	// Commandlets don't pump game thread tasks, so they generate in place like the cvar's synchronous mode
+	if (CVarHeightFieldAsyncNoise.GetValueOnGameThread() == 0 || IsRunningCommandlet())
+	{
+		RunJob(*Job);
+		ApplyJob(*Job);
+		return;
+	}
 
-	// Setup example height data
-	const int32 NumberOfPoints = (LengthSections + 1) * (WidthSections + 1);
+	// The previous mesh stays up until the new one is ready
+	PendingJob = Job;
+	TWeakObjectPtr<AHeightFieldNoiseActor> WeakThis(this);
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis, Job]()
+	{
+		if (!RunJob(*Job))
+		{
+			return;
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Job]()
+		{
+			// Stale results (a newer generation started, or the actor is gone) are dropped
+			AHeightFieldNoiseActor* Actor = WeakThis.Get();
+			if (Actor && !Job->bCancelled && Job->GenerationId == Actor->GenerationId)
+			{
+				Actor->PendingJob.Reset();
+				Actor->ApplyJob(*Job);
+			}
+		});
+	});
+}
 
-	// Fill height data with random values
-	for (int32 i = 0; i < NumberOfPoints; i++)
+void AHeightFieldNoiseActor::CancelPendingJob()
+{
+	if (PendingJob.IsValid())
 	{
-		HeightValues[i] = RngStream.FRandRange(0, Size.Z);
+		PendingJob->bCancelled = true;
+		PendingJob.Reset();
 	}
 }
 
-void AHeightFieldNoiseActor::GenerateMesh()
+bool AHeightFieldNoiseActor::RunJob(FHeightFieldNoiseJob& Job)
 {
-	if (!IsValid(MeshComponent))
+	// Fill height data with noise in [0, Size.Z], rows on worker threads
+	const int32 NumRows = Job.LengthSections + 1;
+	const int32 NumColumns = Job.WidthSections + 1;
+	const int32 RowsPerBand = FMath::Max(NoiseJobSamplesPerBand / NumColumns, 1);
+	Job.HeightValues.SetNumUninitialized(NumRows * NumColumns);
+	for (int32 FirstRow = 0; FirstRow < NumRows; FirstRow += RowsPerBand)
 	{
-		return;
+		if (Job.bCancelled)
+		{
+			return false;
+		}
+		FProceduralNoise::FillGrid(Job.Noise, Job.Seed, FirstRow, 0, FMath::Min(RowsPerBand, NumRows - FirstRow), NumColumns,
+			Job.HeightValues.GetData() + FirstRow * NumColumns, static_cast<float>(Job.Size.Z));
+	}
+
+	// Patches sample the height grid directly, so only the heights are needed
+	if (Job.bTerrainLOD || Job.bCancelled)
+	{
+		return !Job.bCancelled;
+	}
+
+	const bool bShared = Job.GridVertices == EHeightFieldGridVertices::Shared;
+	const int32 VertexCount = bShared ? NumRows * NumColumns : Job.LengthSections * Job.WidthSections * 4; // 4x vertices per quad/section unless shared
+	const int32 TriangleCount = Job.LengthSections * Job.WidthSections * 2 * 3; // 2x3 vertex indexes per quad
+	Job.Positions.SetNumUninitialized(VertexCount);
+	Job.Normals.SetNumUninitialized(VertexCount);
+	Job.Tangents.SetNumUninitialized(VertexCount);
+	Job.TexCoords.SetNumUninitialized(VertexCount);
+	Job.Triangles.SetNumUninitialized(TriangleCount);
+
+	const FVector2D GridSize(Job.Size.X, Job.Size.Y);
+	if (bShared)
+	{
+		GenerateSharedGrid(Job.Positions, Job.Triangles, Job.Normals, Job.Tangents, Job.TexCoords, GridSize, Job.LengthSections, Job.WidthSections, Job.HeightValues);
 	}
+	else
+	{
+		GenerateGrid(Job.Positions, Job.Triangles, Job.Normals, Job.Tangents, Job.TexCoords, GridSize, Job.LengthSections, Job.WidthSections, Job.HeightValues);
+	}
+	return !Job.bCancelled;
+}
 
+void AHeightFieldNoiseActor::ApplyJob(FHeightFieldNoiseJob& Job)
+{
 	MeshComponent->ClearAllMeshSections();
+	HeightValues = MoveTemp(Job.HeightValues);
+	HeightRowLength = Job.WidthSections + 1;
 
-	if (Size.X < 1 || Size.Y < 1 || LengthSections < 1 || WidthSections < 1)
+	if (Job.bTerrainLOD)
 	{
+		// Patches share their vertices; faceted quads get the faceted normals of the uniform grids
+		const EHeightFieldNormalMode PatchNormalMode = Job.GridVertices == EHeightFieldGridVertices::Shared ? EHeightFieldNormalMode::Smooth : EHeightFieldNormalMode::Faceted;
+		TerrainLODState.Init(MeshComponent, Job.TerrainLOD, PatchNormalMode, Job.Size, Job.LengthSections, Job.WidthSections, 0.0f, static_cast<float>(Job.Size.Z));
+		UpdateTerrain();
 		return;
 	}
 
-	SetupMeshBuffers();
-	GeneratePoints();
-	GenerateGrid(Positions, Triangles, Normals, Tangents, TexCoords, FVector2D(Size.X, Size.Y), LengthSections, WidthSections, HeightValues);
+	// Patches of an earlier terrain LOD generation refer to the old heights
+	TerrainLODState = FHeightFieldTerrainLOD();
 
-	MeshComponent->CreateMeshSection_LinearColor(0, Positions, Triangles, Normals, TexCoords, {}, {}, {}, {}, Tangents, false);
+	MeshComponent->CreateMeshSection_LinearColor(0, Job.Positions, Job.Triangles, Job.Normals, Job.TexCoords, {}, {}, {}, {}, Job.Tangents, false);
 	if (Material)
 	{
 		MeshComponent->SetMaterial(0, Material);
@@ -172,3 +316,88 @@ void AHeightFieldNoiseActor::GenerateGrid(TArray<FVector>& InVertices, TArray<in
 		}
 	}
 }
+
+void AHeightFieldNoiseActor::GenerateSharedGrid(TArray<FVector>& InVertices, TArray<int32>& InTriangles, TArray<FVector>& InNormals, TArray<FProcMeshTangent>& InTangents, TArray<FVector2D>& InTexCoords, const FVector2D InSize, const int32 InLengthSections, const int32 InWidthSections, const TArray<float>& InHeightValues)
+{
+	// One vertex per height sample, laid out like the height values so the same index addresses both
+	const FVector2D SectionSize = FVector2D(InSize.X / InLengthSections, InSize.Y / InWidthSections);
+	const int32 RowLength = InWidthSections + 1;
+	int32 TriangleIndex = 0;
+
+	for (int32 X = 0; X < InLengthSections + 1; X++)
+	{
+		for (int32 Y = 0; Y < InWidthSections + 1; Y++)
+		{
+			const int32 VertexIndex = X * RowLength + Y;
+			InVertices[VertexIndex] = FVector(X * SectionSize.X, Y * SectionSize.Y, InHeightValues[VertexIndex]);
+			InTexCoords[VertexIndex] = FVector2D(static_cast<float>(X) / static_cast<float>(InLengthSections), static_cast<float>(Y) / static_cast<float>(InWidthSections));
+			InNormals[VertexIndex] = FVector::ZeroVector;
+		}
+	}
+
+	for (int32 X = 0; X < InLengthSections; X++)
+	{
+		for (int32 Y = 0; Y < InWidthSections; Y++)
+		{
+			// Same corners and winding as the faceted grid, but indexing the shared vertices
+			const int32 BottomLeftIndex = X * RowLength + Y;
+			const int32 BottomRightIndex = BottomLeftIndex + 1;
+			const int32 TopLeftIndex = (X + 1) * RowLength + Y;
+			const int32 TopRightIndex = TopLeftIndex + 1;
+
+			InTriangles[TriangleIndex++] = BottomLeftIndex;
+			InTriangles[TriangleIndex++] = TopRightIndex;
+			InTriangles[TriangleIndex++] = TopLeftIndex;
+
+			InTriangles[TriangleIndex++] = BottomLeftIndex;
+			InTriangles[TriangleIndex++] = BottomRightIndex;
+			InTriangles[TriangleIndex++] = TopRightIndex;
+
+			// Accumulate the unnormalized quad normal into its corners, so every vertex ends up with the
+			// area weighted average of the quads around it
+			const FVector QuadNormal = FVector::CrossProduct(InVertices[BottomLeftIndex] - InVertices[TopLeftIndex], InVertices[TopLeftIndex] - InVertices[TopRightIndex]);
+			InNormals[BottomLeftIndex] += QuadNormal;
+			InNormals[BottomRightIndex] += QuadNormal;
+			InNormals[TopRightIndex] += QuadNormal;
+			InNormals[TopLeftIndex] += QuadNormal;
+		}
+	}
+
+	for (int32 X = 0; X < InLengthSections + 1; X++)
+	{
+		for (int32 Y = 0; Y < InWidthSections + 1; Y++)
+		{
+			const int32 VertexIndex = X * RowLength + Y;
+			InNormals[VertexIndex] = InNormals[VertexIndex].GetSafeNormal();
+
+			// Tangent along -Y like the faceted grid, from the neighbouring samples
+			const int32 PrevIndex = X * RowLength + FMath::Max(Y - 1, 0);
+			const int32 NextIndex = X * RowLength + FMath::Min(Y + 1, InWidthSections);
+			InTangents[VertexIndex] = FProcMeshTangent((InVertices[PrevIndex] - InVertices[NextIndex]).GetSafeNormal(), /*bFlipTangentY=*/ false);
+		}
+	}
+}
+
+// Memory of the mesh arrays a generation job builds and of the copy the procedural mesh component keeps, for both vertex modes
+static FAutoConsoleCommand HeightFieldGridMemoryCommand(
+	TEXT("HeightField.GridMemory"),
+	TEXT("Logs the vertex and index memory of the noise heightfield grid in faceted and shared vertex mode. Optional argument: sections per side (default 1000)."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int64 Sections = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+		const int64 NumIndices = Sections * Sections * 6;
+		const int64 JobBytesPerVertex = sizeof(FVector) * 2 + sizeof(FProcMeshTangent) + sizeof(FVector2D);
+		const int64 ComponentBytesPerVertex = sizeof(FProcMeshVertex);
+		const int64 IndexBytes = NumIndices * sizeof(int32);
+
+		auto LogMode = [&](const TCHAR* Name, int64 NumVertices)
+		{
+			UE_LOG(LogHeightFieldNoise, Log, TEXT("%s: %lld vertices, generation arrays %.1f MB, component section %.1f MB, indices %.1f MB"),
+				Name, NumVertices, (NumVertices * JobBytesPerVertex) / (1024.0 * 1024.0),
+				(NumVertices * ComponentBytesPerVertex) / (1024.0 * 1024.0), IndexBytes / (1024.0 * 1024.0));
+		};
+
+		UE_LOG(LogHeightFieldNoise, Log, TEXT("Noise heightfield grid, %lld x %lld sections:"), Sections, Sections);
+		LogMode(TEXT("Faceted quads"), Sections * Sections * 4);
+		LogMode(TEXT("Shared vertices"), (Sections + 1) * (Sections + 1));
+	}));
@@ -7,8 +7,21 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "RuntimeProceduralMeshComponent.h"
+#include "HeightFieldTerrainLOD.h"
+#include "ProceduralNoise.h"
 #include "HeightFieldNoiseActor.generated.h"
 
+struct FHeightFieldNoiseJob;
+
+UENUM(BlueprintType)
+enum class EHeightFieldGridVertices : uint8
+{
+	// Four vertices per quad, each with the quad's face normal
+	FacetedQuads     UMETA(DisplayName = "Faceted Quads"),
+	// One vertex per height sample, shared by the surrounding quads, with averaged normals
+	Shared           UMETA(DisplayName = "Shared (Indexed)")
+};
+
 UCLASS()
 class PROCEDURALMESHDEMOS_API AHeightFieldNoiseActor : public AActor
 {
@@ -29,15 +42,32 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
 	int32 RandomSeed = 1238;
 
+	// Heights are hash(seed, x, y) based, so a grid point keeps its height when the grid is resized
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	FProceduralNoiseSettings Noise;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
 	UMaterialInterface* Material;
 
+	// Shared vertices need about a quarter of the vertex memory and upload (see HeightField.GridMemory)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	EHeightFieldGridVertices GridVertices = EHeightFieldGridVertices::FacetedQuads;
+
+	// Draw the grid as distance based LOD patches instead of one uniform mesh
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	FHeightFieldTerrainLODSettings TerrainLOD;
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 	virtual void PostLoad() override;
+	virtual void BeginDestroy() override;
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 
+	// Only ticks in terrain LOD mode, to follow the camera (editor camera included)
+	virtual void Tick(float DeltaSeconds) override;
+	virtual bool ShouldTickIfViewportsOnly() const override { return TerrainLOD.bEnabled; }
+
 protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Transient)
 	URuntimeProceduralMeshComponent* MeshComponent;
@@ -45,19 +75,23 @@ protected:
 private:
 	bool bRequiresMeshRebuild = false;
 
+	// Starts generating heights and mesh buffers on a background task, cancelling the one in flight.
+	// The result is applied on the game thread, unless a newer generation has started by then.
 	void GenerateMesh();
-	void GeneratePoints();
+	void CancelPendingJob();
+	void ApplyJob(FHeightFieldNoiseJob& Job);
+	void UpdateTerrain();
+	static bool RunJob(FHeightFieldNoiseJob& Job);
 	static void GenerateGrid(TArray<FVector>& InVertices, TArray<int32>& InTriangles, TArray<FVector>& InNormals, TArray<FProcMeshTangent>& InTangents, TArray<FVector2D>& InTexCoords, const FVector2D InSize, const int32 InLengthSections, const int32 InWidthSections, const TArray<float>& InHeightValues);
+	static void GenerateSharedGrid(TArray<FVector>& InVertices, TArray<int32>& InTriangles, TArray<FVector>& InNormals, TArray<FProcMeshTangent>& InTangents, TArray<FVector2D>& InTexCoords, const FVector2D InSize, const int32 InLengthSections, const int32 InWidthSections, const TArray<float>& InHeightValues);
 
-	FRandomStream RngStream;
-
+	// Heights of the applied generation, which may be older than the current parameters while a job runs
 	TArray<float> HeightValues;
+	int32 HeightRowLength = 0;
+
+	FHeightFieldTerrainLOD TerrainLODState;
+	TArray<FVector> TerrainViews;
 
-	// Mesh buffers
-	void SetupMeshBuffers();
-	TArray<FVector> Positions;
-	TArray<int32> Triangles;
-	TArray<FVector> Normals;
-	TArray<FProcMeshTangent> Tangents;
-	TArray<FVector2D> TexCoords;
+	TSharedPtr<FHeightFieldNoiseJob, ESPMode::ThreadSafe> PendingJob;
+	uint32 GenerationId = 0;
 };
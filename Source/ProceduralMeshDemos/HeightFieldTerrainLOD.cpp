@@ -0,0 +1,289 @@
+// Copyright Sigurdur Gunnarsson. All Rights Reserved.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+// Distance based quadtree LOD for the heightfield examples: grid patches of varying resolution with skirts
+
+#include "HeightFieldTerrainLOD.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+void FHeightFieldTerrainLOD::Init(UProceduralMeshComponent* Mesh, const FHeightFieldTerrainLODSettings& InSettings, EHeightFieldNormalMode InNormalMode,
+	const FVector& InSize, int32 InLengthSections, int32 InWidthSections, float InMinZ, float InMaxZ)
+{
+	Settings = InSettings;
+	NormalMode = InNormalMode;
+	Settings.PatchSections = FMath::Clamp(Settings.PatchSections, 4, 128);
+	Settings.NumLevels = FMath::Clamp(Settings.NumLevels, 1, 8);
+	LengthSections = InLengthSections;
+	WidthSections = InWidthSections;
+	SectionSize = FVector2D(InSize.X / InLengthSections, InSize.Y / InWidthSections);
+	MinZ = InMinZ;
+	MaxZ = InMaxZ;
+
+	Mesh->ClearAllMeshSections();
+	PatchToSection.Reset();
+	FreeSections.Reset();
+	NumSections = 0;
+}
+
+int32 FHeightFieldTerrainLOD::Update(UProceduralMeshComponent* Mesh, UMaterialInterface* Material, TConstArrayView<FVector> LocalViews,
+	FFillHeights FillHeights, bool bHeightsChanged)
+{
+	// Top level nodes tile the grid; the quadtree below them is walked from scratch every update, which only
+	// touches a handful of nodes per selected patch
+	TArray<FPatch> Selected;
+	const int32 TopLevel = Settings.NumLevels - 1;
+	for (int32 NodeX = 0; NodeX < FMath::DivideAndRoundUp(LengthSections, GetNodeSpan(TopLevel)); NodeX++)
+	{
+		for (int32 NodeY = 0; NodeY < FMath::DivideAndRoundUp(WidthSections, GetNodeSpan(TopLevel)); NodeY++)
+		{
+			SelectPatches(TopLevel, NodeX, NodeY, LocalViews, Selected);
+		}
+	}
+
+	// Patches that are no longer selected give their section back
+	TSet<uint64> SelectedKeys;
+	SelectedKeys.Reserve(Selected.Num());
+	for (const FPatch& Patch : Selected)
+	{
+		SelectedKeys.Add(Patch.GetKey());
+	}
+	for (auto It = PatchToSection.CreateIterator(); It; ++It)
+	{
+		if (!SelectedKeys.Contains(It.Key()))
+		{
+			Mesh->ClearMeshSection(It.Value());
+			FreeSections.Add(It.Value());
+			It.RemoveCurrent();
+		}
+	}
+
+	struct FPatchBuild
+	{
+		FPatch Patch;
+		int32 Section = 0;
+		bool bCreate = false;
+	};
+	TArray<FPatchBuild> Builds;
+	for (const FPatch& Patch : Selected)
+	{
+		if (const int32* ExistingSection = PatchToSection.Find(Patch.GetKey()))
+		{
+			// Same patch as last update: only new heights make it worth touching
+			if (bHeightsChanged)
+			{
+				Builds.Add({ Patch, *ExistingSection, false });
+			}
+			continue;
+		}
+
+		const int32 Section = FreeSections.Num() > 0 ? FreeSections.Pop(EAllowShrinking::No) : NumSections++;
+		PatchToSection.Add(Patch.GetKey(), Section);
+		Builds.Add({ Patch, Section, true });
+	}
+
+	// Patches are built on worker threads, each into its own buffers; the mesh sections are then updated here
+	if (PatchBuffers.Num() < Builds.Num())
+	{
+		PatchBuffers.SetNum(Builds.Num());
+	}
+	ParallelFor(Builds.Num(), [this, &Builds, FillHeights](int32 Index)
+	{
+		BuildPatch(Builds[Index].Patch, FillHeights, Builds[Index].bCreate, PatchBuffers[Index]);
+	}, Builds.Num() <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	for (int32 Index = 0; Index < Builds.Num(); Index++)
+	{
+		const FPatchBuild& Build = Builds[Index];
+		const FPatchBuffers& Buffers = PatchBuffers[Index];
+		if (Build.bCreate)
+		{
+			Mesh->CreateMeshSection_LinearColor(Build.Section, Buffers.Positions, Buffers.Triangles, Buffers.Normals, Buffers.TexCoords, {}, {}, {}, {}, Buffers.Tangents, false);
+			Mesh->SetMaterial(Build.Section, Material);
+		}
+		else
+		{
+			Mesh->UpdateMeshSection(Build.Section, Buffers.Positions, Buffers.Normals, Buffers.TexCoords, {}, {}, {}, {}, Buffers.Tangents);
+		}
+	}
+	return Builds.Num();
+}
+
+void FHeightFieldTerrainLOD::GetLocalViewLocations(const AActor* Actor, TArray<FVector>& OutLocalViews)
+{
+	OutLocalViews.Reset();
+	if (const UWorld* World = Actor->GetWorld())
+	{
+		const FTransform& ActorTransform = Actor->GetActorTransform();
+		for (const FVector& ViewLocation : World->ViewLocationsRenderedLastFrame)
+		{
+			OutLocalViews.Add(ActorTransform.InverseTransformPosition(ViewLocation));
+		}
+	}
+}
+
+// A node is split while any view is within the range of the level below it
+void FHeightFieldTerrainLOD::SelectPatches(int32 Level, int32 NodeX, int32 NodeY, TConstArrayView<FVector> LocalViews, TArray<FPatch>& OutPatches) const
+{
+	// Nodes hanging off the far edges of the grid have nothing to draw
+	if (NodeX * GetNodeSpan(Level) >= LengthSections || NodeY * GetNodeSpan(Level) >= WidthSections)
+	{
+		return;
+	}
+
+	if (Level > 0)
+	{
+		const float SplitDistance = Settings.LOD0Distance * static_cast<float>(1 << (Level - 1));
+		const FBox Bounds = GetNodeBounds(Level, NodeX, NodeY);
+		const bool bSplit = LocalViews.ContainsByPredicate([&Bounds, SplitDistance](const FVector& View)
+		{
+			return Bounds.ComputeSquaredDistanceToPoint(View) < FMath::Square(SplitDistance);
+		});
+
+		if (bSplit)
+		{
+			for (int32 Child = 0; Child < 4; Child++)
+			{
+				SelectPatches(Level - 1, NodeX * 2 + (Child & 1), NodeY * 2 + (Child >> 1), LocalViews, OutPatches);
+			}
+			return;
+		}
+	}
+
+	OutPatches.Add({ Level, NodeX, NodeY });
+}
+
+FBox FHeightFieldTerrainLOD::GetNodeBounds(int32 Level, int32 NodeX, int32 NodeY) const
+{
+	const int32 Span = GetNodeSpan(Level);
+	return FBox(
+		FVector(NodeX * Span * SectionSize.X, NodeY * Span * SectionSize.Y, MinZ),
+		FVector(FMath::Min((NodeX + 1) * Span, LengthSections) * SectionSize.X, FMath::Min((NodeY + 1) * Span, WidthSections) * SectionSize.Y, MaxZ));
+}
+
+// Every patch is PatchSections x PatchSections quads (fewer at the grid edges) sampling every 2^Level-th grid point.
+// Heights are evaluated with a one point apron, so normals and tangents along the patch edges are computed from the
+// same heights as on the other side of the seam. Normals follow the uniform grids: central differences when smooth,
+// or the normal of the quad up and to the right of the vertex (clamped at the far edges of the grid) when faceted.
+// Tangents run along -Y, like the noise heightfield's grid.
+void FHeightFieldTerrainLOD::BuildPatch(const FPatch& Patch, FFillHeights FillHeights, bool bTopology, FPatchBuffers& Buffers) const
+{
+	const int32 Stride = 1 << Patch.Level;
+	const int32 Span = GetNodeSpan(Patch.Level);
+	const int32 FirstX = Patch.NodeX * Span;
+	const int32 FirstY = Patch.NodeY * Span;
+	const int32 NumX = FMath::DivideAndRoundUp(FMath::Min(Span, LengthSections - FirstX), Stride);
+	const int32 NumY = FMath::DivideAndRoundUp(FMath::Min(Span, WidthSections - FirstY), Stride);
+	const int32 ApronRows = NumX + 3;
+	const int32 ApronColumns = NumY + 3;
+
+	Buffers.ApronCoordsX.SetNumUninitialized(ApronRows, EAllowShrinking::No);
+	Buffers.ApronCoordsY.SetNumUninitialized(ApronColumns, EAllowShrinking::No);
+	Buffers.ApronGridY.SetNumUninitialized(ApronColumns, EAllowShrinking::No);
+	Buffers.ApronHeights.SetNumUninitialized(ApronRows * ApronColumns, EAllowShrinking::No);
+	Buffers.ApronNormalRow.SetNumUninitialized(ApronColumns, EAllowShrinking::No);
+
+	const TArray<int32>& GridY = Buffers.ApronGridY;
+	for (int32 Column = 0; Column < ApronColumns; Column++)
+	{
+		Buffers.ApronGridY[Column] = FMath::Clamp(FirstY + (Column - 1) * Stride, 0, WidthSections);
+		Buffers.ApronCoordsY[Column] = static_cast<float>(GridY[Column] * SectionSize.Y);
+	}
+	for (int32 Row = 0; Row < ApronRows; Row++)
+	{
+		Buffers.ApronCoordsX[Row] = static_cast<float>(FMath::Clamp(FirstX + (Row - 1) * Stride, 0, LengthSections) * SectionSize.X);
+	}
+	FillHeights(FirstX - Stride, FirstY - Stride, Stride, ApronRows, ApronColumns, Buffers.ApronHeights.GetData());
+
+	auto GetApronPoint = [&Buffers, ApronColumns](int32 Row, int32 Column)
+	{
+		return FVector(Buffers.ApronCoordsX[Row], Buffers.ApronCoordsY[Column], Buffers.ApronHeights[Row * ApronColumns + Column]);
+	};
+
+	// Grid vertices, followed by one skirt vertex below every edge vertex
+	const int32 NumGridVertices = (NumX + 1) * (NumY + 1);
+	const int32 NumSkirtVertices = 2 * (NumX + 1) + 2 * (NumY + 1);
+	Buffers.Positions.SetNumUninitialized(NumGridVertices + NumSkirtVertices, EAllowShrinking::No);
+	Buffers.Normals.SetNumUninitialized(NumGridVertices + NumSkirtVertices, EAllowShrinking::No);
+	Buffers.Tangents.SetNumUninitialized(NumGridVertices + NumSkirtVertices, EAllowShrinking::No);
+	Buffers.TexCoords.SetNumUninitialized(NumGridVertices + NumSkirtVertices, EAllowShrinking::No);
+
+	for (int32 X = 0; X < NumX + 1; X++)
+	{
+		const int32 Row = X + 1;
+		const int32 GridX = FMath::Min(FirstX + X * Stride, LengthSections);
+		if (NormalMode == EHeightFieldNormalMode::Smooth)
+		{
+			FillSmoothGridNormalsRow(Row, Buffers.ApronHeights.GetData(), 1, Buffers.ApronCoordsX, Buffers.ApronCoordsY, Buffers.ApronNormalRow.GetData());
+		}
+
+		for (int32 Y = 0; Y < NumY + 1; Y++)
+		{
+			const int32 Column = Y + 1;
+			const int32 Idx = X * (NumY + 1) + Y;
+			Buffers.Positions[Idx] = GetApronPoint(Row, Column);
+			Buffers.TexCoords[Idx] = FVector2D(static_cast<float>(GridX) / LengthSections, static_cast<float>(GridY[Column]) / WidthSections);
+			Buffers.Tangents[Idx] = FProcMeshTangent((GetApronPoint(Row, Column - 1) - GetApronPoint(Row, Column + 1)).GetSafeNormal(), /*bFlipTangentY=*/ false);
+
+			if (NormalMode == EHeightFieldNormalMode::Smooth)
+			{
+				Buffers.Normals[Idx] = Buffers.ApronNormalRow[Column];
+			}
+			else
+			{
+				const int32 TopRightRow = GridX < LengthSections ? Row + 1 : Row;
+				const int32 TopRightColumn = GridY[Column] < WidthSections ? Column + 1 : Column;
+				const FVector TopRight = GetApronPoint(TopRightRow, TopRightColumn);
+				const FVector TopLeft = GetApronPoint(TopRightRow, TopRightColumn - 1);
+				const FVector BottomLeft = GetApronPoint(TopRightRow - 1, TopRightColumn - 1);
+				Buffers.Normals[Idx] = FVector::CrossProduct(BottomLeft - TopLeft, TopLeft - TopRight).GetSafeNormal();
+			}
+		}
+	}
+
+	TArray<int32>& Triangles = Buffers.Triangles;
+	if (bTopology)
+	{
+		Triangles.Reset();
+		for (int32 X = 1; X < NumX + 1; X++)
+		{
+			for (int32 Y = 1; Y < NumY + 1; Y++)
+			{
+				const int32 TopRight = (X * (NumY + 1)) + Y;
+				const int32 TopLeft = TopRight - 1;
+				const int32 BottomRight = ((X - 1) * (NumY + 1)) + Y;
+				const int32 BottomLeft = BottomRight - 1;
+				Triangles.Append({ BottomLeft, TopRight, TopLeft, BottomLeft, BottomRight, TopRight });
+			}
+		}
+	}
+
+	// Skirts along the four edges. They are seen from either side depending on the neighbour, so both windings are emitted.
+	int32 SkirtVertex = NumGridVertices;
+	auto AddSkirt = [this, &Buffers, &Triangles, &SkirtVertex, bTopology](int32 FirstGridVertex, int32 GridVertexStep, int32 NumEdgeVertices)
+	{
+		for (int32 Edge = 0; Edge < NumEdgeVertices; Edge++)
+		{
+			const int32 GridVertex = FirstGridVertex + Edge * GridVertexStep;
+			Buffers.Positions[SkirtVertex + Edge] = Buffers.Positions[GridVertex] - FVector(0.0f, 0.0f, Settings.SkirtDepth);
+			Buffers.Normals[SkirtVertex + Edge] = Buffers.Normals[GridVertex];
+			Buffers.Tangents[SkirtVertex + Edge] = Buffers.Tangents[GridVertex];
+			Buffers.TexCoords[SkirtVertex + Edge] = Buffers.TexCoords[GridVertex];
+
+			if (bTopology && Edge > 0)
+			{
+				const int32 A = GridVertex - GridVertexStep;
+				const int32 B = GridVertex;
+				const int32 SkirtA = SkirtVertex + Edge - 1;
+				const int32 SkirtB = SkirtVertex + Edge;
+				Triangles.Append({ A, B, SkirtB, A, SkirtB, SkirtA });
+				Triangles.Append({ A, SkirtB, B, A, SkirtA, SkirtB });
+			}
+		}
+		SkirtVertex += NumEdgeVertices;
+	};
+	AddSkirt(0, 1, NumY + 1);
+	AddSkirt(NumX * (NumY + 1), 1, NumY + 1);
+	AddSkirt(0, NumY + 1, NumX + 1);
+	AddSkirt(NumY, NumY + 1, NumX + 1);
+}
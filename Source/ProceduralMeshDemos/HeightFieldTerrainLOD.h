@@ -0,0 +1,110 @@
+// Copyright Sigurdur Gunnarsson. All Rights Reserved.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+// Distance based quadtree LOD for the heightfield examples: grid patches of varying resolution with skirts
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProceduralMeshComponent.h"
+#include "HeightFieldWave.h"
+#include "HeightFieldTerrainLOD.generated.h"
+
+class UMaterialInterface;
+
+USTRUCT(BlueprintType)
+struct PROCEDURALMESHDEMOS_API FHeightFieldTerrainLODSettings
+{
+	GENERATED_BODY()
+
+	// Replace the uniform grid with a quadtree of patches whose resolution follows the camera distance
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain LOD")
+	bool bEnabled = false;
+
+	// Grid sections along each side of a patch, at every level
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain LOD", meta = (ClampMin = "4", ClampMax = "128"))
+	int32 PatchSections = 32;
+
+	// Level N patches sample every 2^N-th grid point and cover 2^N times the area of a level 0 patch
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain LOD", meta = (ClampMin = "1", ClampMax = "8"))
+	int32 NumLevels = 4;
+
+	// Patches closer to the camera than this are drawn at full resolution; the range doubles with every level
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain LOD", meta = (ClampMin = "1"))
+	float LOD0Distance = 2000.0f;
+
+	// How far the skirts along patch edges hang down, hiding the cracks between patches of different levels
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain LOD", meta = (ClampMin = "0"))
+	float SkirtDepth = 50.0f;
+};
+
+// Picks the quadtree patches for the current views and keeps one procedural mesh section per patch.
+// Patches are only rebuilt when they are added to the selection (or when the heights themselves change).
+class PROCEDURALMESHDEMOS_API FHeightFieldTerrainLOD
+{
+public:
+	// Fills NumRows x NumColumns row-major heights of the grid points X = Clamp(FirstX + Row * Stride, 0, LengthSections),
+	// Y = Clamp(FirstY + Column * Stride, 0, WidthSections). Patches are built on worker threads, so this is called
+	// from several threads at once.
+	using FFillHeights = TFunctionRef<void(int32 FirstX, int32 FirstY, int32 Stride, int32 NumRows, int32 NumColumns, float* OutHeights)>;
+
+	// Clears the mesh and starts over with a new grid. MinZ/MaxZ bound the heights, for patch distances.
+	void Init(UProceduralMeshComponent* Mesh, const FHeightFieldTerrainLODSettings& InSettings, EHeightFieldNormalMode InNormalMode,
+		const FVector& InSize, int32 InLengthSections, int32 InWidthSections, float InMinZ, float InMaxZ);
+
+	// Selects patches for the given views (in the mesh's local space) and updates the mesh sections that changed.
+	// With bHeightsChanged every selected patch is rebuilt. Returns the number of patches built.
+	int32 Update(UProceduralMeshComponent* Mesh, UMaterialInterface* Material, TConstArrayView<FVector> LocalViews,
+		FFillHeights FillHeights, bool bHeightsChanged);
+
+	int32 GetNumPatches() const { return PatchToSection.Num(); }
+
+	// Where the world's views were last frame (editor viewports included), in the actor's local space
+	static void GetLocalViewLocations(const AActor* Actor, TArray<FVector>& OutLocalViews);
+
+private:
+	struct FPatch
+	{
+		int32 Level = 0;
+		int32 NodeX = 0;
+		int32 NodeY = 0;
+
+		uint64 GetKey() const { return (static_cast<uint64>(Level) << 56) | (static_cast<uint64>(NodeX) << 28) | static_cast<uint64>(NodeY); }
+	};
+
+	// Scratch buffers for building one patch, reused across patches and frames
+	struct FPatchBuffers
+	{
+		TArray<float> ApronHeights;
+		TArray<float> ApronCoordsX;
+		TArray<float> ApronCoordsY;
+		TArray<int32> ApronGridY;
+		TArray<FVector> ApronNormalRow;
+		TArray<FVector> Positions;
+		TArray<FVector> Normals;
+		TArray<FProcMeshTangent> Tangents;
+		TArray<FVector2D> TexCoords;
+		TArray<int32> Triangles;
+	};
+
+	void SelectPatches(int32 Level, int32 NodeX, int32 NodeY, TConstArrayView<FVector> LocalViews, TArray<FPatch>& OutPatches) const;
+	FBox GetNodeBounds(int32 Level, int32 NodeX, int32 NodeY) const;
+	void BuildPatch(const FPatch& Patch, FFillHeights FillHeights, bool bTopology, FPatchBuffers& Buffers) const;
+
+	int32 GetNodeSpan(int32 Level) const { return Settings.PatchSections << Level; }
+
+	FHeightFieldTerrainLODSettings Settings;
+	EHeightFieldNormalMode NormalMode = EHeightFieldNormalMode::Smooth;
+	FVector2D SectionSize = FVector2D::ZeroVector;
+	int32 LengthSections = 0;
+	int32 WidthSections = 0;
+	float MinZ = 0.0f;
+	float MaxZ = 0.0f;
+
+	// Mesh section of every selected patch, and the sections left empty by patches that went away
+	TMap<uint64, int32> PatchToSection;
+	TArray<int32> FreeSections;
+	int32 NumSections = 0;
+
+	// One set per patch built in the same update, so they can be built in parallel
+	TArray<FPatchBuffers> PatchBuffers;
+};
@@ -0,0 +1,291 @@
+// Copyright Sigurdur Gunnarsson. All Rights Reserved.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+// Large animated heightfield split into chunks, each its own direct proxy mesh with its own bounds
+// Only chunks the camera sees (or is about to see) are regenerated and uploaded every frame
+
+#include "HeightFieldTiledDirectProxyActor.h"
+#include "DirectProxyMeshComponent.h"
+#include "Async/ParallelFor.h"
+
+AHeightFieldTiledDirectProxyActor::AHeightFieldTiledDirectProxyActor()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	SetRootComponent(CreateDefaultSubobject<USceneComponent>(TEXT("Root")));
+}
+
+void AHeightFieldTiledDirectProxyActor::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+	SetActorTickEnabled(AnimateMesh);
+
+	const bool bChunksLost = ChunkComponents.ContainsByPredicate([](const UDirectProxyMeshComponent* Component) { return !IsValid(Component); });
+	if (bRequiresMeshRebuild || !bMeshCreated || bChunksLost)
+	{
+		bMeshCreated = false;
+		GenerateMesh();
+		bRequiresMeshRebuild = false;
+	}
+}
+
+void AHeightFieldTiledDirectProxyActor::BeginPlay()
+{
+	Super::BeginPlay();
+	SetActorTickEnabled(AnimateMesh);
+
+	// Chunk components aren't saved, so loaded actors build them here
+	if (!bMeshCreated)
+	{
+		GenerateMesh();
+	}
+}
+
+#if WITH_EDITOR
+void AHeightFieldTiledDirectProxyActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (PropertyChangedEvent.MemberProperty && PropertyChangedEvent.MemberProperty->GetOwnerClass()->IsChildOf(StaticClass()))
+	{
+		bRequiresMeshRebuild = true;
+	}
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+}
+#endif
+
+void AHeightFieldTiledDirectProxyActor::Tick(float DeltaSeconds)
+{
+	if (AnimateMesh && bMeshCreated)
+	{
+		CurrentAnimationFrameX += DeltaSeconds * AnimationSpeedX;
+		CurrentAnimationFrameY += DeltaSeconds * AnimationSpeedY;
+		UpdateChunks(false);
+	}
+}
+
+FHeightFieldWave AHeightFieldTiledDirectProxyActor::GetWave() const
+{
+	FHeightFieldWave Wave;
+	Wave.ScaleFactor = ScaleFactor;
+	Wave.FrameX = CurrentAnimationFrameX;
+	Wave.FrameY = CurrentAnimationFrameY;
+	Wave.Amplitude = static_cast<float>(Size.Z);
+	return Wave;
+}
+
+void AHeightFieldTiledDirectProxyActor::DestroyChunks()
+{
+	for (UDirectProxyMeshComponent* Component : ChunkComponents)
+	{
+		if (IsValid(Component))
+		{
+			Component->DestroyComponent();
+		}
+	}
+	ChunkComponents.Reset();
+	Chunks.Reset();
+}
+
+void AHeightFieldTiledDirectProxyActor::GenerateMesh()
+{
+	DestroyChunks();
+
+	if (Size.X < 1 || Size.Y < 1 || LengthSections < 1 || WidthSections < 1 || ChunkSections < 1)
+	{
+		bMeshCreated = false;
+		return;
+	}
+
+	const FVector2D SectionSize = FVector2D(Size.X / LengthSections, Size.Y / WidthSections);
+	const float LengthSectionsF = static_cast<float>(LengthSections);
+	const float WidthSectionsF = static_cast<float>(WidthSections);
+
+	for (int32 ChunkX = 0; ChunkX < GetNumChunksX(); ChunkX++)
+	{
+		for (int32 ChunkY = 0; ChunkY < GetNumChunksY(); ChunkY++)
+		{
+			FChunk& Chunk = Chunks.AddDefaulted_GetRef();
+			Chunk.FirstX = ChunkX * ChunkSections;
+			Chunk.FirstY = ChunkY * ChunkSections;
+			Chunk.NumX = FMath::Min(ChunkSections, LengthSections - Chunk.FirstX);
+			Chunk.NumY = FMath::Min(ChunkSections, WidthSections - Chunk.FirstY);
+
+			// Apron coordinates are clamped to the heightfield, so the outer edge repeats its last point
+			Chunk.ApronCoordsX.SetNumUninitialized(Chunk.NumX + 3);
+			Chunk.ApronCoordsY.SetNumUninitialized(Chunk.NumY + 3);
+			for (int32 X = 0; X < Chunk.NumX + 3; X++)
+			{
+				Chunk.ApronCoordsX[X] = static_cast<float>(FMath::Clamp(Chunk.FirstX + X - 1, 0, LengthSections) * SectionSize.X);
+			}
+			for (int32 Y = 0; Y < Chunk.NumY + 3; Y++)
+			{
+				Chunk.ApronCoordsY[Y] = static_cast<float>(FMath::Clamp(Chunk.FirstY + Y - 1, 0, WidthSections) * SectionSize.Y);
+			}
+			Chunk.ApronHeights.SetNumUninitialized((Chunk.NumX + 3) * (Chunk.NumY + 3));
+			Chunk.ApronNormalRow.SetNumUninitialized(Chunk.NumY + 3);
+
+			// Chunk topology, with UVs across the whole heightfield
+			const int32 NumVerts = Chunk.GetNumVertices();
+			TArray<uint32> Indices;
+			TArray<FVector2f> TexCoords;
+			TArray<FVector2f> GridXY;
+			Indices.Reserve(Chunk.NumX * Chunk.NumY * 2 * 3);
+			TexCoords.AddUninitialized(NumVerts);
+			GridXY.AddUninitialized(StreamHeightsOnly ? NumVerts : 0);
+			for (int32 X = 0; X < Chunk.NumX + 1; X++)
+			{
+				for (int32 Y = 0; Y < Chunk.NumY + 1; Y++)
+				{
+					const int32 Idx = X * (Chunk.NumY + 1) + Y;
+					TexCoords[Idx] = FVector2f((Chunk.FirstX + X) / LengthSectionsF, (Chunk.FirstY + Y) / WidthSectionsF);
+					if (StreamHeightsOnly)
+					{
+						GridXY[Idx] = FVector2f(Chunk.ApronCoordsX[X + 1], Chunk.ApronCoordsY[Y + 1]);
+					}
+
+					if (X > 0 && Y > 0)
+					{
+						const int32 TopRight = Idx;
+						const int32 TopLeft = TopRight - 1;
+						const int32 BottomRight = ((X - 1) * (Chunk.NumY + 1)) + Y;
+						const int32 BottomLeft = BottomRight - 1;
+
+						Indices.Append({ static_cast<uint32>(BottomLeft), static_cast<uint32>(TopRight), static_cast<uint32>(TopLeft) });
+						Indices.Append({ static_cast<uint32>(BottomLeft), static_cast<uint32>(BottomRight), static_cast<uint32>(TopRight) });
+					}
+				}
+			}
+
+			UDirectProxyMeshComponent* Component = NewObject<UDirectProxyMeshComponent>(this, NAME_None, RF_Transient);
+			Component->SetupAttachment(GetRootComponent());
+			Component->SetMaterial(0, Material);
+			if (StreamHeightsOnly)
+			{
+				Component->SetStaticGridTopology(MoveTemp(Indices), MoveTemp(TexCoords), MoveTemp(GridXY));
+			}
+			else
+			{
+				Component->SetStaticTopology(MoveTemp(Indices), MoveTemp(TexCoords), NumVerts);
+			}
+
+			// Per-chunk bounds are what lets the renderer cull chunks; Z is conservative from the wave amplitude
+			Component->SetFixedBounds(FBox(
+				FVector(Chunk.ApronCoordsX[1], Chunk.ApronCoordsY[1], -Size.Z),
+				FVector(Chunk.ApronCoordsX[Chunk.NumX + 1], Chunk.ApronCoordsY[Chunk.NumY + 1], Size.Z)));
+			Component->RegisterComponent();
+			ChunkComponents.Add(Component);
+		}
+	}
+
+	bMeshCreated = true;
+
+	// Every chunk starts out with current heights, whether it has been seen yet or not
+	UpdateChunks(true);
+}
+
+void AHeightFieldTiledDirectProxyActor::UpdateChunks(bool bAllChunks)
+{
+	const int32 NumChunksX = GetNumChunksX();
+	const int32 NumChunksY = GetNumChunksY();
+	check(Chunks.Num() == NumChunksX * NumChunksY && ChunkComponents.Num() == Chunks.Num());
+
+	// Visible chunks and their neighbours, so chunks scrolling into view already match the ones next to them
+	TBitArray<> ChunksToUpdate(bAllChunks, Chunks.Num());
+	if (!bAllChunks)
+	{
+		for (int32 ChunkX = 0; ChunkX < NumChunksX; ChunkX++)
+		{
+			for (int32 ChunkY = 0; ChunkY < NumChunksY; ChunkY++)
+			{
+				if (!ChunkComponents[ChunkX * NumChunksY + ChunkY]->WasRecentlyRendered(VisibilityTimeout))
+				{
+					continue;
+				}
+				for (int32 NeighbourX = FMath::Max(ChunkX - 1, 0); NeighbourX <= FMath::Min(ChunkX + 1, NumChunksX - 1); NeighbourX++)
+				{
+					for (int32 NeighbourY = FMath::Max(ChunkY - 1, 0); NeighbourY <= FMath::Min(ChunkY + 1, NumChunksY - 1); NeighbourY++)
+					{
+						ChunksToUpdate[NeighbourX * NumChunksY + NeighbourY] = true;
+					}
+				}
+			}
+		}
+	}
+
+	// Frames are acquired and submitted on the game thread; the chunks are filled on worker threads in between
+	TArray<int32> UpdateIndices;
+	TArray<FDirectProxyFramePtr> Frames;
+	for (TConstSetBitIterator<> It(ChunksToUpdate); It; ++It)
+	{
+		UpdateIndices.Add(It.GetIndex());
+		Frames.Add(ChunkComponents[It.GetIndex()]->AcquireFrame());
+	}
+	NumChunksUpdated = UpdateIndices.Num();
+
+	const FHeightFieldWave Wave = GetWave();
+	ParallelFor(UpdateIndices.Num(), [this, &UpdateIndices, &Frames, &Wave](int32 Index)
+	{
+		FDirectProxyFrame& Frame = *Frames[Index];
+		FillChunk(Chunks[UpdateIndices[Index]], Wave, Frame.Positions, Frame.Heights, Frame.Normals);
+	});
+
+	for (int32 Index = 0; Index < UpdateIndices.Num(); Index++)
+	{
+		ChunkComponents[UpdateIndices[Index]]->SubmitFrame(Frames[Index].ToSharedRef());
+	}
+}
+
+// Evaluates the chunk with its apron, then copies the inner points out. Positions or heights are filled depending on
+// which one the frame was sized for.
+void AHeightFieldTiledDirectProxyActor::FillChunk(FChunk& Chunk, const FHeightFieldWave& Wave,
+	TArray<FVector3f>& OutPositions, TArray<float>& OutHeights, TArray<FVector3f>& OutNormals) const
+{
+	const int32 ApronRows = Chunk.NumX + 3;
+	const int32 ApronColumns = Chunk.NumY + 3;
+	const int32 NumColumns = Chunk.NumY + 1;
+	const bool bHeights = OutHeights.Num() > 0;
+
+	Chunk.WaveTables.Build(Wave, ApronRows, ApronColumns, 1, LengthSections, WidthSections, Chunk.FirstX - 1, Chunk.FirstY - 1);
+	for (int32 Row = 0; Row < ApronRows; Row++)
+	{
+		Chunk.WaveTables.FillRow(Row, Chunk.ApronHeights.GetData() + Row * ApronColumns);
+	}
+
+	auto ApronPosition = [&Chunk, ApronColumns](int32 Row, int32 Column)
+	{
+		return FVector3f(Chunk.ApronCoordsX[Row], Chunk.ApronCoordsY[Column], Chunk.ApronHeights[Row * ApronColumns + Column]);
+	};
+
+	for (int32 X = 0; X < Chunk.NumX + 1; X++)
+	{
+		const float* RowHeights = Chunk.ApronHeights.GetData() + (X + 1) * ApronColumns + 1;
+		if (bHeights)
+		{
+			FMemory::Memcpy(OutHeights.GetData() + X * NumColumns, RowHeights, NumColumns * sizeof(float));
+		}
+		else
+		{
+			for (int32 Y = 0; Y < NumColumns; Y++)
+			{
+				OutPositions[X * NumColumns + Y] = FVector3f(Chunk.ApronCoordsX[X + 1], Chunk.ApronCoordsY[Y + 1], RowHeights[Y]);
+			}
+		}
+
+		if (NormalMode == EHeightFieldNormalMode::Smooth)
+		{
+			FillSmoothGridNormalsRow(X + 1, Chunk.ApronHeights.GetData(), 1, Chunk.ApronCoordsX, Chunk.ApronCoordsY, Chunk.ApronNormalRow.GetData());
+			FMemory::Memcpy(OutNormals.GetData() + X * NumColumns, Chunk.ApronNormalRow.GetData() + 1, NumColumns * sizeof(FVector3f));
+			continue;
+		}
+
+		// Faceted: the quad up and to the right of the point in the whole heightfield, clamped at its far edges.
+		// Points on a chunk's far border read that quad from the apron, the same one the next chunk uses.
+		const int32 QuadRow = FMath::Min(Chunk.FirstX + X + 1, LengthSections) - Chunk.FirstX + 1;
+		for (int32 Y = 0; Y < NumColumns; Y++)
+		{
+			const int32 QuadColumn = FMath::Min(Chunk.FirstY + Y + 1, WidthSections) - Chunk.FirstY + 1;
+			const FVector3f TopLeft = ApronPosition(QuadRow, QuadColumn - 1);
+			OutNormals[X * NumColumns + Y] = FVector3f::CrossProduct(
+				ApronPosition(QuadRow - 1, QuadColumn - 1) - TopLeft,
+				TopLeft - ApronPosition(QuadRow, QuadColumn)).GetSafeNormal();
+		}
+	}
+}
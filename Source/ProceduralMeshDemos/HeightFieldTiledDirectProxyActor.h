@@ -0,0 +1,117 @@
+// Copyright Sigurdur Gunnarsson. All Rights Reserved.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+// Large animated heightfield split into chunks, each its own direct proxy mesh with its own bounds
+// Only chunks the camera sees (or is about to see) are regenerated and uploaded every frame
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "HeightFieldWave.h"
+#include "HeightFieldTiledDirectProxyActor.generated.h"
+
+class UDirectProxyMeshComponent;
+
+UCLASS()
+class PROCEDURALMESHDEMOS_API AHeightFieldTiledDirectProxyActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AHeightFieldTiledDirectProxyActor();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	FVector Size = FVector(40000.0f, 40000.0f, 100.0f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	float ScaleFactor = 0.1f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	int32 LengthSections = 1024;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	int32 WidthSections = 1024;
+
+	// Grid sections along each side of a chunk. Edge chunks get whatever is left over.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters", meta = (ClampMin = "8", ClampMax = "255"))
+	int32 ChunkSections = 64;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	UMaterialInterface* Material;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	bool AnimateMesh = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	float AnimationSpeedX = 4.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	float AnimationSpeedY = 4.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	EHeightFieldNormalMode NormalMode = EHeightFieldNormalMode::Faceted;
+
+	// Only stream heights and normals (8 bytes per vertex), see AHeightFieldDirectProxyActor
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters")
+	bool StreamHeightsOnly = false;
+
+	// A chunk keeps animating for this long after it was last drawn
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Procedural Parameters", meta = (ClampMin = "0"))
+	float VisibilityTimeout = 0.25f;
+
+	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void BeginPlay() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	int32 GetNumChunks() const { return Chunks.Num(); }
+
+	// Chunks regenerated by the last update
+	int32 GetNumChunksUpdated() const { return NumChunksUpdated; }
+
+protected:
+	float CurrentAnimationFrameX = 0.0f;
+	float CurrentAnimationFrameY = 0.0f;
+
+private:
+	// Grid points [FirstX, FirstX + NumX] x [FirstY, FirstY + NumY] of the whole heightfield. Neighbouring chunks share
+	// their border points, and every chunk also evaluates a one point apron around itself, so border positions and
+	// normals are computed from the same inputs on both sides of a seam.
+	struct FChunk
+	{
+		int32 FirstX = 0;
+		int32 FirstY = 0;
+		int32 NumX = 0;
+		int32 NumY = 0;
+
+		// Heights of the chunk plus apron, (NumX + 3) x (NumY + 3), reused every frame
+		FHeightFieldWaveTables WaveTables;
+		TArray<float> ApronHeights;
+		TArray<float> ApronCoordsX;
+		TArray<float> ApronCoordsY;
+		TArray<FVector3f> ApronNormalRow;
+
+		int32 GetNumVertices() const { return (NumX + 1) * (NumY + 1); }
+	};
+
+	void GenerateMesh();
+	void DestroyChunks();
+	void UpdateChunks(bool bAllChunks);
+	void FillChunk(FChunk& Chunk, const FHeightFieldWave& Wave, TArray<FVector3f>& OutPositions, TArray<float>& OutHeights, TArray<FVector3f>& OutNormals) const;
+	FHeightFieldWave GetWave() const;
+
+	int32 GetNumChunksX() const { return FMath::DivideAndRoundUp(LengthSections, ChunkSections); }
+	int32 GetNumChunksY() const { return FMath::DivideAndRoundUp(WidthSections, ChunkSections); }
+
+	// Components are created at runtime, one per chunk, in the same order as Chunks
+	UPROPERTY(Transient)
+	TArray<UDirectProxyMeshComponent*> ChunkComponents;
+
+	TArray<FChunk> Chunks;
+	int32 NumChunksUpdated = 0;
+	bool bMeshCreated = false;
+	bool bRequiresMeshRebuild = false;
+};
@@ -0,0 +1,152 @@
+// Copyright Sigurdur Gunnarsson. All Rights Reserved.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+// Sine and cosine wave shared by the animated height field examples, with a separable table evaluation
+
+#include "HeightFieldWave.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogHeightFieldWave, Log, All);
+
+static TAutoConsoleVariable<int32> CVarHeightFieldWaveTables(
+	TEXT("HeightField.WaveTables"),
+	1,
+	TEXT("1 evaluates the animated height field waves from per-row and per-column trig tables.\n")
+	TEXT("0 uses the reference path with four sin/cos calls per vertex."),
+	ECVF_Default);
+
+bool UseHeightFieldWaveTables()
+{
+	return CVarHeightFieldWaveTables.GetValueOnGameThread() != 0;
+}
+
+void FHeightFieldWaveTables::Build(const FHeightFieldWave& Wave, int32 NumRows, int32 NumColumns, int32 Stride, int32 MaxX, int32 MaxY, int32 FirstX, int32 FirstY)
+{
+	RowCosOne.SetNumUninitialized(NumRows, EAllowShrinking::No);
+	RowCosTwo.SetNumUninitialized(NumRows, EAllowShrinking::No);
+	ColumnSinOne.SetNumUninitialized(NumColumns, EAllowShrinking::No);
+	ColumnSinTwo.SetNumUninitialized(NumColumns, EAllowShrinking::No);
+	Amplitude = Wave.Amplitude;
+
+	// Same expressions as FHeightFieldWave::Evaluate, so the table entries are bit-identical to its factors
+	for (int32 Row = 0; Row < NumRows; Row++)
+	{
+		const int32 X = FMath::Clamp(FirstX + Row * Stride, 0, MaxX);
+		RowCosOne[Row] = FMath::Cos((X + Wave.FrameX) * Wave.ScaleFactor);
+		RowCosTwo[Row] = FMath::Cos((X + Wave.FrameX * 0.7f) * Wave.ScaleFactor * 2.5f);
+	}
+	for (int32 Column = 0; Column < NumColumns; Column++)
+	{
+		const int32 Y = FMath::Clamp(FirstY + Column * Stride, 0, MaxY);
+		ColumnSinOne[Column] = FMath::Sin((Y + Wave.FrameY) * Wave.ScaleFactor);
+		ColumnSinTwo[Column] = FMath::Sin((Y - Wave.FrameY * 0.7f) * Wave.ScaleFactor * 2.5f);
+	}
+}
+
+void FHeightFieldWaveTables::FillRow(int32 Row, float* RESTRICT OutHeights, int32 OutStride) const
+{
+	const int32 NumColumns = ColumnSinOne.Num();
+	const float CosOne = RowCosOne[Row];
+	const float CosTwo = RowCosTwo[Row];
+	const float* RESTRICT SinOne = ColumnSinOne.GetData();
+	const float* RESTRICT SinTwo = ColumnSinTwo.GetData();
+
+	const VectorRegister4Float CosOneVec = VectorSetFloat1(CosOne);
+	const VectorRegister4Float CosTwoVec = VectorSetFloat1(CosTwo);
+	const VectorRegister4Float HalfVec = VectorSetFloat1(0.5f);
+	const VectorRegister4Float AmplitudeVec = VectorSetFloat1(Amplitude);
+
+	// Separate multiplies and adds in the reference order, no fused multiply-add, to match Evaluate
+	int32 Column = 0;
+	for (; Column + 4 <= NumColumns; Column += 4)
+	{
+		const VectorRegister4Float ValueOne = VectorMultiply(CosOneVec, VectorLoad(SinOne + Column));
+		const VectorRegister4Float ValueTwo = VectorMultiply(CosTwoVec, VectorLoad(SinTwo + Column));
+		const VectorRegister4Float Heights = VectorMultiply(VectorMultiply(VectorAdd(ValueOne, ValueTwo), HalfVec), AmplitudeVec);
+		if (OutStride == 1)
+		{
+			VectorStore(Heights, OutHeights + Column);
+		}
+		else
+		{
+			alignas(16) float Lanes[4];
+			VectorStoreAligned(Heights, Lanes);
+			for (int32 Lane = 0; Lane < 4; Lane++)
+			{
+				OutHeights[(Column + Lane) * OutStride] = Lanes[Lane];
+			}
+		}
+	}
+	for (; Column < NumColumns; Column++)
+	{
+		OutHeights[Column * OutStride] = ((CosOne * SinOne[Column] + CosTwo * SinTwo[Column]) * 0.5f) * Amplitude;
+	}
+}
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+// Single threaded, so the numbers show the per-vertex cost rather than the worker count
+static void BenchmarkHeightFieldWave(int32 GridSize)
+{
+	const int32 NumPoints = GridSize + 1;
+	TArray<float> ReferenceHeights;
+	TArray<float> TableHeights;
+	ReferenceHeights.SetNumUninitialized(NumPoints * NumPoints);
+	TableHeights.SetNumUninitialized(NumPoints * NumPoints);
+
+	FHeightFieldWave Wave;
+	Wave.ScaleFactor = 0.05f;
+	Wave.FrameX = 12.5f;
+	Wave.FrameY = 7.25f;
+	Wave.Amplitude = 100.0f;
+
+	const int32 NumIterations = FMath::Max(1, (1024 * 1024 * 8) / (NumPoints * NumPoints));
+
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+	{
+		for (int32 X = 0; X < NumPoints; X++)
+		{
+			for (int32 Y = 0; Y < NumPoints; Y++)
+			{
+				ReferenceHeights[X * NumPoints + Y] = Wave.Evaluate(X, Y);
+			}
+		}
+	}
+	const double ReferenceMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumIterations;
+
+	FHeightFieldWaveTables Tables;
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+	{
+		// Rebuilt every iteration, like the animated actors do every frame
+		Tables.Build(Wave, NumPoints, NumPoints, 1, GridSize, GridSize);
+		for (int32 X = 0; X < NumPoints; X++)
+		{
+			Tables.FillRow(X, TableHeights.GetData() + X * NumPoints);
+		}
+	}
+	const double TableMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumIterations;
+
+	float MaxError = 0.0f;
+	for (int32 i = 0; i < ReferenceHeights.Num(); i++)
+	{
+		MaxError = FMath::Max(MaxError, FMath::Abs(ReferenceHeights[i] - TableHeights[i]));
+	}
+
+	UE_LOG(LogHeightFieldWave, Log, TEXT("%4d x %-4d: reference %8.3f ms, tables %8.3f ms, %5.1fx faster, max difference %g"),
+		GridSize, GridSize, ReferenceMs, TableMs, TableMs > 0.0 ? ReferenceMs / TableMs : 0.0, MaxError);
+}
+
+static FAutoConsoleCommand HeightFieldWaveBenchmarkCommand(
+	TEXT("HeightField.BenchmarkWave"),
+	TEXT("Times the reference wave evaluation against the separable trig tables on 256, 1024 and 4096 grids."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (const int32 GridSize : { 256, 1024, 4096 })
+		{
+			BenchmarkHeightFieldWave(GridSize);
+		}
+	}));
@@ -0,0 +1,91 @@
+// Copyright Sigurdur Gunnarsson. All Rights Reserved.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+// Sine and cosine wave shared by the animated height field examples, with a separable table evaluation
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HeightFieldWave.generated.h"
+
+UENUM(BlueprintType)
+enum class EHeightFieldNormalMode : uint8
+{
+	// One normal per quad, written to its corners
+	Faceted     UMETA(DisplayName = "Faceted"),
+	// Central differences of the height grid, computed independently for every vertex
+	Smooth      UMETA(DisplayName = "Smooth")
+};
+
+// Two Cos(X) * Sin(Y) terms with some hardcoded offsets. Every term is a function of X times a function of Y,
+// so a grid only needs one table per axis and the per-vertex work is a few multiplies and adds.
+struct PROCEDURALMESHDEMOS_API FHeightFieldWave
+{
+	float ScaleFactor = 1.0f;
+	float FrameX = 0.0f;
+	float FrameY = 0.0f;
+	float Amplitude = 0.0f;
+
+	// Reference evaluation, four transcendentals per call
+	float Evaluate(int32 X, int32 Y) const
+	{
+		const float ValueOne = FMath::Cos((X + FrameX) * ScaleFactor) * FMath::Sin((Y + FrameY) * ScaleFactor);
+		const float ValueTwo = FMath::Cos((X + FrameX * 0.7f) * ScaleFactor * 2.5f) * FMath::Sin((Y - FrameY * 0.7f) * ScaleFactor * 2.5f);
+		return ((ValueOne + ValueTwo) * 0.5f) * Amplitude;
+	}
+};
+
+// Per-row cosines and per-column sines of a wave over a grid, rebuilt every frame: O(rows + columns) trig calls
+// instead of O(rows * columns). Row I samples X = Clamp(FirstX + I * Stride, 0, MaxX), and columns sample Y the same way.
+// Heights match FHeightFieldWave::Evaluate exactly, as long as the compiler doesn't contract the scalar tail into FMAs.
+class PROCEDURALMESHDEMOS_API FHeightFieldWaveTables
+{
+public:
+	void Build(const FHeightFieldWave& Wave, int32 NumRows, int32 NumColumns, int32 Stride, int32 MaxX, int32 MaxY, int32 FirstX = 0, int32 FirstY = 0);
+
+	// Writes the heights of one row, four columns per SIMD register. OutStride is in floats, so positions can be
+	// filled in place by pointing at the first Z.
+	void FillRow(int32 Row, float* RESTRICT OutHeights, int32 OutStride = 1) const;
+
+	int32 GetNumRows() const { return RowCosOne.Num(); }
+	int32 GetNumColumns() const { return ColumnSinOne.Num(); }
+
+private:
+	TArray<float> RowCosOne;
+	TArray<float> RowCosTwo;
+	TArray<float> ColumnSinOne;
+	TArray<float> ColumnSinTwo;
+	float Amplitude = 0.0f;
+};
+
+// Evaluates the wave through the tables (default) or the reference path, for comparing the two in game
+PROCEDURALMESHDEMOS_API bool UseHeightFieldWaveTables();
+
+// Central-difference normals of one row of a height grid (one-sided at the edges). Heights are row-major, HeightStride
+// floats apart, so they can be read from the Z of a position array. RowCoords/ColumnCoords hold the X/Y of every
+// row/column, which also covers the shorter last step of a grid clamped to its far edge. Every vertex only reads
+// heights, so rows can be filled on any thread in any order.
+template <typename VectorType>
+void FillSmoothGridNormalsRow(int32 Row, const float* RESTRICT Heights, int32 HeightStride,
+	TConstArrayView<float> RowCoords, TConstArrayView<float> ColumnCoords, VectorType* RESTRICT OutRowNormals)
+{
+	const int32 NumRows = RowCoords.Num();
+	const int32 NumColumns = ColumnCoords.Num();
+	const int32 PrevRow = FMath::Max(Row - 1, 0);
+	const int32 NextRow = FMath::Min(Row + 1, NumRows - 1);
+	const float* RESTRICT PrevHeights = Heights + PrevRow * NumColumns * HeightStride;
+	const float* RESTRICT NextHeights = Heights + NextRow * NumColumns * HeightStride;
+	const float* RESTRICT RowHeights = Heights + Row * NumColumns * HeightStride;
+	const float DeltaX = RowCoords[NextRow] - RowCoords[PrevRow];
+
+	for (int32 Column = 0; Column < NumColumns; Column++)
+	{
+		const int32 Left = FMath::Max(Column - 1, 0);
+		const int32 Right = FMath::Min(Column + 1, NumColumns - 1);
+		const float DeltaY = ColumnCoords[Right] - ColumnCoords[Left];
+		const float SlopeX = NextHeights[Column * HeightStride] - PrevHeights[Column * HeightStride];
+		const float SlopeY = RowHeights[Right * HeightStride] - RowHeights[Left * HeightStride];
+
+		// Cross product of the X tangent (DeltaX, 0, SlopeX) and the Y tangent (0, DeltaY, SlopeY)
+		OutRowNormals[Column] = VectorType(-SlopeX * DeltaY, -DeltaX * SlopeY, DeltaX * DeltaY).GetSafeNormal();
+	}
+}
@@ -0,0 +1,111 @@
+// Copyright Sigurdur Gunnarsson. All Rights Reserved.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+// Stateless, counter based noise for the heightfield examples: every sample is a pure function of (seed, x, y)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProceduralNoise.generated.h"
+
+UENUM(BlueprintType)
+enum class EProceduralNoiseType : uint8
+{
+	// An independent random value per grid point
+	White       UMETA(DisplayName = "White (Hash)"),
+	// Smoothly interpolated random values on a lattice
+	Value       UMETA(DisplayName = "Value"),
+	// Perlin style gradient noise, fewer grid artifacts than value noise
+	Gradient    UMETA(DisplayName = "Gradient"),
+	// Folded gradient noise with sharp crests, for mountain ridges
+	Ridged      UMETA(DisplayName = "Ridged"),
+	// Gradient noise sampled at coordinates displaced by two more gradient noise fields
+	Warped      UMETA(DisplayName = "Domain Warped")
+};
+
+USTRUCT(BlueprintType)
+struct PROCEDURALMESHDEMOS_API FProceduralNoiseSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise")
+	EProceduralNoiseType Type = EProceduralNoiseType::White;
+
+	// Lattice cells per grid point of the first octave (ignored by white noise)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise", meta = (ClampMin = "0.0001"))
+	float Frequency = 0.05f;
+
+	// Layers of fBm; each one has Lacunarity times the frequency and Gain times the amplitude of the previous one.
+	// White noise is a single layer.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise", meta = (ClampMin = "1", ClampMax = "12"))
+	int32 Octaves = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise")
+	float Lacunarity = 2.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise")
+	float Gain = 0.5f;
+
+	// How far domain warping moves a sample, in grid points
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise", meta = (EditCondition = "Type == EProceduralNoiseType::Warped"))
+	float WarpStrength = 20.0f;
+};
+
+// Nothing here keeps state between samples, so grids can be filled in any order, on any number of threads, in
+// tiles or resized, and the value at a grid point never changes. The batch and grid entry points evaluate four
+// samples per SIMD register with the same operations, in the same order, as the scalar ones.
+struct PROCEDURALMESHDEMOS_API FProceduralNoise
+{
+	// 32-bit hash of a seed and an integer lattice point
+	static uint32 Hash(uint32 Seed, int32 X, int32 Y)
+	{
+		return Mix(static_cast<uint32>(X) * 0x8DA6B343u + static_cast<uint32>(Y) * 0xD8163841u + Seed * 0xCB1AB31Fu);
+	}
+
+	// Top 24 bits of a hash as a float in [0, 1)
+	static float HashToUnit(uint32 HashValue)
+	{
+		return static_cast<float>(HashValue >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// Single octaves, all in [0, 1]
+	static float White(uint32 Seed, int32 X, int32 Y) { return HashToUnit(Hash(Seed, X, Y)); }
+	static float Value(uint32 Seed, float X, float Y);
+	static float Gradient(uint32 Seed, float X, float Y);
+
+	// fBm of the settings' noise type at a point in grid units, normalized to [0, 1]. White noise takes the
+	// grid point the coordinates fall in.
+	static float Sample(const FProceduralNoiseSettings& Settings, uint32 Seed, float X, float Y);
+
+	// Count samples at arbitrary points (heightfields, sphere displacement, ...) times Scale, four per SIMD register.
+	// Batches of 4, 8 or 16 keep every lane busy; other counts finish with scalar samples.
+	static void SampleBatch(const FProceduralNoiseSettings& Settings, uint32 Seed, const float* X, const float* Y,
+		int32 Count, float* OutValues, float Scale = 1.0f);
+
+	// Fills a row-major NumRows x NumColumns block of grid points starting at (FirstX, FirstY) with samples times
+	// Scale, rows on worker threads. The block's values are the same ones any other block covering those points gets.
+	static void FillGrid(const FProceduralNoiseSettings& Settings, uint32 Seed, int32 FirstX, int32 FirstY,
+		int32 NumRows, int32 NumColumns, float* OutValues, float Scale = 1.0f);
+
+	// Same, sizing a row-major array to NumRows * NumColumns first
+	static void FillGrid(const FProceduralNoiseSettings& Settings, uint32 Seed, int32 FirstX, int32 FirstY,
+		int32 NumRows, int32 NumColumns, TArray<float>& OutValues, float Scale = 1.0f);
+
+	// One row of NumColumns grid points starting at (X, FirstY), on the calling thread
+	static void FillRow(const FProceduralNoiseSettings& Settings, uint32 Seed, int32 X, int32 FirstY,
+		int32 NumColumns, float* OutValues, float Scale = 1.0f);
+
+private:
+	// Integer finalizer with good avalanche (lowbias32)
+	static uint32 Mix(uint32 Bits)
+	{
+		Bits ^= Bits >> 16;
+		Bits *= 0x7FEB352Du;
+		Bits ^= Bits >> 15;
+		Bits *= 0x846CA68Bu;
+		Bits ^= Bits >> 16;
+		return Bits;
+	}
+
+	// One row of white noise, four hashes per SIMD register
+	static void FillWhiteRow(uint32 Seed, int32 X, int32 FirstY, int32 NumColumns, float* OutValues, float Scale);
+};
@@ -0,0 +1,70 @@
+// Copyright Sigurdur Gunnarsson. All Rights Reserved.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+// GPU expansion of height-only grid updates into full position and tangent streams
+
+#include "DirectProxyHeightFieldShaders.h"
+#include "GlobalShader.h"
+#include "ShaderParameterStruct.h"
+#include "RenderGraphUtils.h"
+#include "RHICommandList.h"
+
+class FDirectProxyHeightFieldExpandCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FDirectProxyHeightFieldExpandCS);
+	SHADER_USE_PARAMETER_STRUCT(FDirectProxyHeightFieldExpandCS, FGlobalShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(uint32, FirstVertex)
+		SHADER_PARAMETER(uint32, NumVertices)
+		SHADER_PARAMETER(uint32, GroupCountX)
+		SHADER_PARAMETER_SRV(Buffer<float2>, GridXY)
+		SHADER_PARAMETER_SRV(Buffer<float>, Heights)
+		SHADER_PARAMETER_SRV(Buffer<float4>, PackedNormals)
+		SHADER_PARAMETER_UAV(RWBuffer<float>, OutPositions)
+		SHADER_PARAMETER_UAV(RWBuffer<float4>, OutTangents)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static constexpr uint32 ThreadGroupSize = 64;
+
+	// Groups per row of the dispatch; large grids wrap into Y to stay under the per-dimension group limit
+	static constexpr uint32 MaxGroupCountX = 32768;
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FDirectProxyHeightFieldExpandCS, "/ProceduralMeshDemos/Private/DirectProxyHeightFieldExpand.usf", "MainCS", SF_Compute);
+
+void DispatchDirectProxyHeightFieldExpand(FRHICommandList& RHICmdList, ERHIFeatureLevel::Type FeatureLevel, const FDirectProxyHeightFieldExpandParams& Params)
+{
+	if (Params.NumVertices == 0)
+	{
+		return;
+	}
+
+	const uint32 NumGroups = FMath::DivideAndRoundUp(Params.NumVertices, FDirectProxyHeightFieldExpandCS::ThreadGroupSize);
+	const uint32 GroupCountX = FMath::Min(NumGroups, FDirectProxyHeightFieldExpandCS::MaxGroupCountX);
+	const uint32 GroupCountY = FMath::DivideAndRoundUp(NumGroups, GroupCountX);
+
+	FDirectProxyHeightFieldExpandCS::FParameters Parameters;
+	Parameters.FirstVertex = Params.FirstVertex;
+	Parameters.NumVertices = Params.NumVertices;
+	Parameters.GroupCountX = GroupCountX;
+	Parameters.GridXY = Params.GridXY;
+	Parameters.Heights = Params.Heights;
+	Parameters.PackedNormals = Params.PackedNormals;
+	Parameters.OutPositions = Params.OutPositions;
+	Parameters.OutTangents = Params.OutTangents;
+
+	TShaderMapRef<FDirectProxyHeightFieldExpandCS> ComputeShader(GetGlobalShaderMap(FeatureLevel));
+	FComputeShaderUtils::Dispatch(RHICmdList, ComputeShader, Parameters, FIntVector(GroupCountX, GroupCountY, 1));
+}
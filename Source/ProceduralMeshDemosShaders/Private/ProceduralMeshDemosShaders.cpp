@@ -0,0 +1,20 @@
+// Copyright Sigurdur Gunnarsson. All Rights Reserved.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+// Registers the project's shader directory
+
+#include "Modules/ModuleManager.h"
+#include "Misc/Paths.h"
+#include "ShaderCore.h"
+
+class FProceduralMeshDemosShadersModule : public IModuleInterface
+{
+public:
+	virtual void StartupModule() override
+	{
+		// Shaders in <Project>/Shaders are referenced as /ProceduralMeshDemos/...
+		const FString ShaderDirectory = FPaths::Combine(FPaths::ProjectDir(), TEXT("Shaders"));
+		AddShaderSourceDirectoryMapping(TEXT("/ProceduralMeshDemos"), ShaderDirectory);
+	}
+};
+
+IMPLEMENT_MODULE(FProceduralMeshDemosShadersModule, ProceduralMeshDemosShaders);
@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+// Global shaders have to be registered before the shader compiler starts up, so they live in their
+// own module that loads in the PostConfigInit phase (see ProceduralMeshDemos.uproject).
+public class ProceduralMeshDemosShaders : ModuleRules
+{
+    public ProceduralMeshDemosShaders(ReadOnlyTargetRules Target) : base(Target)
+    {
+	    PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "RenderCore", "RHI" });
+    }
+}
@@ -0,0 +1,33 @@
+// Copyright Sigurdur Gunnarsson. All Rights Reserved.
+// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+// GPU expansion of height-only grid updates into full position and tangent streams
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHIFwd.h"
+#include "RHIFeatureLevel.h"
+
+class FRHICommandList;
+
+// Inputs and outputs for one expand dispatch over vertices [FirstVertex, FirstVertex + NumVertices)
+struct FDirectProxyHeightFieldExpandParams
+{
+	// Static per-vertex X/Y (PF_G32R32F), uploaded once with the topology
+	FRHIShaderResourceView* GridXY = nullptr;
+
+	// Per-frame heights (PF_R32_FLOAT) and packed normals (PF_R8G8B8A8_SNORM)
+	FRHIShaderResourceView* Heights = nullptr;
+	FRHIShaderResourceView* PackedNormals = nullptr;
+
+	// Vertex factory streams: 3 floats per vertex, and tangent + normal packed per vertex
+	FRHIUnorderedAccessView* OutPositions = nullptr;
+	FRHIUnorderedAccessView* OutTangents = nullptr;
+
+	uint32 FirstVertex = 0;
+	uint32 NumVertices = 0;
+};
+
+// Writes positions (X/Y from the grid, Z from the heights) and tangent bases for a vertex range.
+// The output UAVs must be in the UAVCompute state.
+PROCEDURALMESHDEMOSSHADERS_API void DispatchDirectProxyHeightFieldExpand(FRHICommandList& RHICmdList, ERHIFeatureLevel::Type FeatureLevel, const FDirectProxyHeightFieldExpandParams& Params);